@@ -0,0 +1,79 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "ConverterBench.h"
+
+bool
+ConverterBench::verify(VideoFormat format)
+{
+    assert(format == VIDEO_YUV420P || format == VIDEO_NV12);
+
+    const int maxWidth = 720, height = 8;
+    bool nv12 = format == VIDEO_NV12;
+    bool result = true;
+
+    u8 *src = new u8[4 * maxWidth * height];
+    u8 *ref = new u8[maxWidth * height * 3 / 2];
+    u8 *out = new u8[maxWidth * height * 3 / 2];
+
+    #if defined(__i386__) || defined(__x86_64__)
+
+    srand(0);
+    for (int round = 0; round < 64; round++) {
+
+        // Vary the width to cover all remainder loops
+        int width = maxWidth - 2 * round;
+        size_t size = width * height * 3 / 2;
+
+        // Fill the first row with extreme values and all others randomly
+        for (int i = 0; i < 4 * width * height; i++) {
+            src[i] = i < 4 * width ? ((i / 4 + round) % 3 ? 0xFF : 0x00) : rand() & 0xFF;
+        }
+
+        ScreenRecorder::convert(src, ref, width, height, nv12, false);
+        ScreenRecorder::convert(src, out, width, height, nv12, true);
+        result &= memcmp(ref, out, size) == 0;
+    }
+
+    #endif
+
+    printf("%s converter: %s\n", sVideoFormat(format), result ? "passed" : "FAILED");
+
+    delete [] src;
+    delete [] ref;
+    delete [] out;
+    return result;
+}
+
+double
+ConverterBench::benchmark(VideoFormat format, bool sse, long count)
+{
+    assert(format == VIDEO_YUV420P || format == VIDEO_NV12);
+
+    const int width = 720, height = 568;
+    bool nv12 = format == VIDEO_NV12;
+
+    u8 *src = new u8[4 * width * height];
+    u8 *dst = new u8[width * height * 3 / 2];
+    for (int i = 0; i < 4 * width * height; i++) src[i] = rand() & 0xFF;
+
+    u64 start = nanos();
+    for (long i = 0; i < count; i++) {
+        ScreenRecorder::convert(src, dst, width, height, nv12, sse);
+    }
+    u64 elapsed = nanos() - start;
+
+    delete [] src;
+    delete [] dst;
+
+    double result = elapsed ? count / ((double)elapsed / 1000000000.0) : 0;
+    printf("%s (%s): %.0f frames/sec\n",
+           sVideoFormat(format), sse ? "SSE" : "scalar", result);
+    return result;
+}
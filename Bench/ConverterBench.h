@@ -0,0 +1,34 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _CONVERTER_BENCH_H
+#define _CONVERTER_BENCH_H
+
+#include "ScreenRecorder.h"
+
+// Verifies and benchmarks the YUV converter of the screen recorder
+class ConverterBench {
+    
+public:
+    
+    /* Checks if the SSE converter produces the same output as the scalar
+     * reference implementation. Both are run on frames with random and
+     * extreme pixel values and various widths. The output must be bit-exact.
+     * On non-Intel hosts, only the scalar converter exists and the check
+     * always passes.
+     */
+    static bool verify(VideoFormat format);
+
+    /* Measures the speed of the YUV converter. A 720 x 568 frame is converted
+     * count times and the result is returned in frames per second.
+     */
+    static double benchmark(VideoFormat format, bool sse, long count = 100);
+};
+
+#endif
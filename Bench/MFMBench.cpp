@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "MFMBench.h"
+#include "ADFFile.h"
+
+bool
+MFMBench::verify(MFMCodec codec)
+{
+    assert(isMFMCodec(codec));
+    
+    const size_t count = 1088;
+    u8 src[count], ref[2 * count + 1], out[2 * count + 1];
+    bool result = true;
+    
+    Disk *disk = new Disk(DISK_35_DD);
+    Disk *refDisk = new Disk(DISK_35_DD);
+    disk->setCodec(codec);
+    refDisk->setCodec(MFM_SCALAR);
+
+    srand(0);
+    for (int round = 0; round < 64; round++) {
+        
+        // Vary the length to cover all remainder loops
+        size_t n = count - round;
+        for (size_t i = 0; i < count; i++) src[i] = rand() & 0xFF;
+        
+        refDisk->encodeMFM(ref, src, n);
+        disk->encodeMFM(out, src, n);
+        result &= memcmp(ref, out, 2 * n) == 0;
+        
+        refDisk->decodeMFM(ref, src, n / 2);
+        disk->decodeMFM(out, src, n / 2);
+        result &= memcmp(ref, out, n / 2) == 0;
+        
+        refDisk->encodeOddEven(ref, src, n / 2);
+        disk->encodeOddEven(out, src, n / 2);
+        result &= memcmp(ref, out, n) == 0;
+
+        refDisk->decodeOddEven(ref, src, n / 2);
+        disk->decodeOddEven(out, src, n / 2);
+        result &= memcmp(ref, out, n / 2) == 0;
+
+        memcpy(ref, src, n);
+        memcpy(out, src, n);
+        refDisk->addClockBits(ref + 1, n - 1);
+        disk->addClockBits(out + 1, n - 1);
+        result &= memcmp(ref, out, n) == 0;
+    }
+    
+    // Run a random ADF through the encoder and the decoder
+    if (ADFFile *adf = ADFFile::makeWithDiskType(DISK_35_DD)) {
+        
+        long size = adf->getSize();
+        u8 *buffer = new u8[size];
+        u8 *decoded = new u8[size];
+        for (long i = 0; i < size; i++) buffer[i] = rand() & 0xFF;
+        adf->readFromBuffer(buffer, size);
+        
+        result &= refDisk->encodeDisk(adf);
+        result &= disk->encodeDisk(adf);
+        for (Track t = 0; t < disk->geometry.tracks; t++) {
+            
+            result &= memcmp(refDisk->ptr(t), disk->ptr(t),
+                             disk->geometry.trackSize) == 0;
+            
+            // Force the decoder to run on all tracks
+            disk->dirty[t] = true;
+        }
+        
+        result &= disk->decodeAmigaDisk(decoded, adf->numTracks(),
+                                        adf->numSectorsPerTrack());
+        result &= memcmp(buffer, decoded, size) == 0;
+        
+        delete [] buffer;
+        delete [] decoded;
+        delete adf;
+    }
+    
+    if (disk->codec != codec) result = false;
+    printf("%s codec: %s\n", mfmCodecName(codec), result ? "passed" : "FAILED");
+    
+    delete disk;
+    delete refDisk;
+    return result;
+}
+
+double
+MFMBench::benchmark(MFMCodec codec, bool decode, long count)
+{
+    assert(isMFMCodec(codec));
+    
+    ADFFile *adf = ADFFile::makeWithDiskType(DISK_35_DD);
+    Disk *disk = new Disk(DISK_35_DD);
+    disk->setCodec(codec);
+    
+    u8 *buffer = new u8[adf->getSize()];
+    u64 elapsed = 0;
+    
+    if (decode) {
+        
+        // Force the decoder to run on all tracks
+        disk->encodeDisk(adf);
+        disk->encodeAllTracks();
+        for (Track t = 0; t < disk->geometry.tracks; t++) disk->dirty[t] = true;
+    }
+    
+    for (long i = 0; i < count; i++) {
+        
+        u64 start = nanos();
+        
+        if (decode) {
+            disk->decodeAmigaDisk(buffer, adf->numTracks(), adf->numSectorsPerTrack());
+        } else {
+            disk->encodeDisk(adf);
+            disk->encodeAllTracks();
+        }
+        
+        elapsed += nanos() - start;
+    }
+    
+    double result = elapsed ? count / ((double)elapsed / 1000000000.0) : 0;
+    printf("%s %s: %.1f disks/sec\n",
+           mfmCodecName(disk->codec), decode ? "decoder" : "encoder", result);
+    
+    delete [] buffer;
+    delete disk;
+    delete adf;
+    return result;
+}
@@ -0,0 +1,32 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _MFM_BENCH_H
+#define _MFM_BENCH_H
+
+#include "Disk.h"
+
+// Verifies and benchmarks the MFM codecs of the disk
+class MFMBench {
+    
+public:
+    
+    /* Checks if a MFM codec produces the same output as the scalar reference
+     * implementation. All primitives are run on random data and a randomly
+     * filled ADF is passed through the full encoder and decoder.
+     */
+    static bool verify(MFMCodec codec);
+    
+    /* Measures the speed of a MFM codec. A DD disk is encoded (or decoded)
+     * count times and the result is returned in disks per second.
+     */
+    static double benchmark(MFMCodec codec, bool decode, long count = 32);
+};
+
+#endif
@@ -0,0 +1,152 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "MuxerBench.h"
+
+double
+MuxerBench::benchmark(Amiga &amiga, SamplingMethod method, long count)
+{
+    assert(isSamplingMethod(method));
+
+    const long chunk = 4096;
+    const Cycle period = DMA_CYCLES(124);
+    Muxer &muxer = amiga.paula.muxer;
+
+    // Setup a scratch muxer with the same configuration
+    Muxer *scratch = new Muxer(amiga);
+    scratch->config = muxer.config;
+    scratch->config.samplingMethod = method;
+    scratch->updateGains();
+    scratch->setSampleRate(muxer.sampleRate);
+    scratch->_reset(true);
+    scratch->clear();
+
+    Cycle clock = 0;
+    Cycle fed = 0;
+    u64 elapsed = 0;
+
+    for (long done = 0; done < count; done += chunk) {
+
+        long n = MIN(count - done, chunk);
+        Cycle target = clock + (Cycle)(n * scratch->cyclesPerSample);
+
+        // Feed the samplers with synthetic data covering the next chunk
+        for (; fed <= target + period; fed += period) {
+            for (int i = 0; i < 4; i++) {
+                i16 value = (i16)(((fed / period) * (i + 3) * 97) % 8192 - 4096);
+                scratch->sampler[i].write( TaggedSample { fed, value } );
+            }
+        }
+
+        u64 start = nanos();
+        scratch->synthesize(clock, target, n);
+        elapsed += nanos() - start;
+
+        scratch->stream.clear();
+        clock = target;
+    }
+
+    delete scratch;
+
+    double result = elapsed ? count / ((double)elapsed / 1000000000.0) : 0;
+    printf("%s: %.0f samples/sec\n", sSamplingMethod(method), result);
+    return result;
+}
+
+double
+MuxerBench::measureQuality(Amiga &amiga, SamplingMethod method)
+{
+    assert(isSamplingMethod(method));
+
+    const int count = 4096;
+    const int length = 32;
+    const Cycle period = DMA_CYCLES(124);
+    const double cps = amiga.paula.muxer.cyclesPerSample;
+    const double omega = 2 * M_PI * cps / (period * length);
+
+    // Play back a sampled sine wave
+    Sampler *s = new Sampler();
+    Cycle start = 64 * (Cycle)cps;
+    Cycle end = start + (Cycle)((count + 64) * cps);
+
+    for (Cycle c = 0, i = 0; c < end; c += period, i++) {
+        double value = 8000 * sin(2 * M_PI * (i % length) / length);
+        s->write( TaggedSample { c, (i16)lround(value) } );
+    }
+
+    // Convert it to the output sample rate
+    float *out = new float[count];
+    int cursor = s->r;
+
+    for (int i = 0; i < count; i += Muxer::blockSize) {
+
+        int n = MIN(count - i, Muxer::blockSize);
+        double clock = start + i * cps;
+
+        if (method == SMP_SINC) {
+            s->resample(clock, cps, out + i, n, cursor);
+            continue;
+        }
+        for (int j = 0; j < n; j++, clock += cps) {
+
+            switch (method) {
+                case SMP_NONE:
+                    out[i + j] = s->interpolate<SMP_NONE>((Cycle)clock, cursor);
+                    break;
+                case SMP_NEAREST:
+                    out[i + j] = s->interpolate<SMP_NEAREST>((Cycle)clock, cursor);
+                    break;
+                default:
+                    out[i + j] = s->interpolate<SMP_LINEAR>((Cycle)clock, cursor);
+                    break;
+            }
+        }
+    }
+
+    // Fit y = a * sin + b * cos + c by the method of least squares
+    double m[3][3] = { }, v[3] = { };
+    for (int i = 0; i < count; i++) {
+        double t = omega * i;
+        double x[3] = { sin(t), cos(t), 1.0 };
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++) m[j][k] += x[j] * x[k];
+            v[j] += x[j] * out[i];
+        }
+    }
+    double det =
+    m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+    m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+    m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    double coeff[3];
+    for (int c = 0; c < 3; c++) {
+        double a[3][3];
+        for (int j = 0; j < 3; j++) {
+            for (int k = 0; k < 3; k++) a[j][k] = k == c ? v[j] : m[j][k];
+        }
+        coeff[c] = (a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+                    a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+                    a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0])) / det;
+    }
+
+    // Compare the signal energy with the energy of the residual
+    double signal = 0, noise = 0;
+    for (int i = 0; i < count; i++) {
+        double t = omega * i;
+        double fit = coeff[0] * sin(t) + coeff[1] * cos(t) + coeff[2];
+        signal += fit * fit;
+        noise += (out[i] - fit) * (out[i] - fit);
+    }
+
+    delete [] out;
+    delete s;
+
+    double result = noise ? 10 * log10(signal / noise) : INFINITY;
+    printf("%s: SNR %.1f dB\n", sSamplingMethod(method), result);
+    return result;
+}
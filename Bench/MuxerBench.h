@@ -0,0 +1,39 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _MUXER_BENCH_H
+#define _MUXER_BENCH_H
+
+#include "Amiga.h"
+
+// Benchmarks the sampling methods of the audio muxer and rates their quality
+class MuxerBench {
+    
+public:
+    
+    /* Measures the throughput of the synthesizer for a certain sampling method
+     * in samples per second. The measurement is carried out by a scratch muxer
+     * which inherits the configuration of the Amiga's muxer and is fed with
+     * synthetic sample data. Hence, it doesn't interfere with the emulator
+     * state.
+     */
+    static double benchmark(Amiga &amiga, SamplingMethod method, long count = 441000);
+
+    /* Measures the output quality of a certain sampling method. A sine wave
+     * is played back at a typical Paula rate of about 28.6 kHz and converted
+     * to the sample rate of the Amiga's muxer. All images of the sine wave are
+     * located above the Nyquist frequency. Hence, everything except the
+     * fundamental that shows up in the output is either aliasing or
+     * interpolation error. The function returns the signal-to-noise ratio in
+     * dB.
+     */
+    static double measureQuality(Amiga &amiga, SamplingMethod method);
+};
+
+#endif
@@ -0,0 +1,48 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "ConverterBench.h"
+#include "MFMBench.h"
+#include "MuxerBench.h"
+
+/* Command line tool that checks the optimized code paths of the emulator
+ * against their reference implementations and measures their speed. The
+ * exit code is non-zero if one of the checks fails.
+ */
+int main(int argc, const char *argv[])
+{
+    bool result = true;
+
+    // MFM codecs of the disk (the fastest one is the last one supported)
+    for (long i = MFM_SCALAR; i <= Disk::preferredCodec(); i++) {
+        
+        result &= MFMBench::verify((MFMCodec)i);
+        MFMBench::benchmark((MFMCodec)i, false);
+        MFMBench::benchmark((MFMCodec)i, true);
+    }
+    
+    // YUV converter of the screen recorder
+    for (VideoFormat format : { VIDEO_YUV420P, VIDEO_NV12 }) {
+        
+        result &= ConverterBench::verify(format);
+        ConverterBench::benchmark(format, false);
+        ConverterBench::benchmark(format, true);
+    }
+    
+    // Sampling methods of the audio muxer
+    Amiga *amiga = new Amiga();
+    for (long i = 0; i < SMP_COUNT; i++) {
+        
+        MuxerBench::benchmark(*amiga, (SamplingMethod)i);
+        MuxerBench::measureQuality(*amiga, (SamplingMethod)i);
+    }
+    delete amiga;
+    
+    return result ? 0 : 1;
+}
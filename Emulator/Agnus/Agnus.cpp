@@ -1013,16 +1013,18 @@ Agnus::vsyncHandler()
             
     // Let other subcomponents do their own VSYNC stuff
     copper.vsyncHandler();
+    paula.diskController.vsyncHandler();
     denise.vsyncHandler();
     controlPort1.joystick.execute();
     controlPort2.joystick.execute();
+    for (int i = 0; i < 4; i++) df[i]->vsyncHandler();
 
     // Update statistics
     updateStats();
     mem.updateStats();
     
     // Count some sheep (zzzzzz) ...
-    if (!amiga.inWarpMode()) {
+    if (!amiga.inWarpMode() && !amiga.isRendering()) {
         amiga.synchronizeTiming();
     }
 }
@@ -237,7 +237,7 @@ Copper::move(u32 addr, u16 value)
         trace(OCSREG_DEBUG, "pokeCustom16(%X [%s], %X)\n", addr, regName(addr), value);
 
         // Color registers
-        pixelEngine.colChanges.insert(4 * agnus.pos.h, RegChange { addr, value} );
+        denise.pokeCOLOR<AGNUS_ACCESS>((addr - 0x180) >> 1, value);
         return;
     }
 
@@ -267,10 +267,12 @@ DmaDebugger::computeOverlay()
     // Only proceed if DMA debugging has been turned on
     if (!enabled) return;
 
-    BusOwner *owners = agnus.busOwner;
-    u16 *values = agnus.busValue;
-    u32 *ptr = denise.pixelEngine.pixelAddr(0);
+    computeOverlay(denise.pixelEngine.pixelAddr(0), agnus.busOwner, agnus.busValue);
+}
 
+void
+DmaDebugger::computeOverlay(u32 *ptr, BusOwner *owners, u16 *values)
+{
     double bgWeight, fgWeight;
 
     switch (displayMode) {
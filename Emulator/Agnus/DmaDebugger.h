@@ -118,6 +118,7 @@ public:
     
     // Superimposes the debug output onto the current rasterline
     void computeOverlay();
+    void computeOverlay(u32 *ptr, BusOwner *owners, u16 *values);
 
     // Cleans up some texture data at the end of each frame
     void vSyncHandler();
@@ -198,6 +198,8 @@ Amiga::getConfigItem(ConfigOption option)
         case OPT_CLX_SPR_SPR:
         case OPT_CLX_SPR_PLF:
         case OPT_CLX_PLF_PLF:
+        case OPT_RENDER_THREAD:
+        case OPT_FRAME_SKIP:
             return denise.getConfigItem(option);
             
         case OPT_RTC_MODEL:
@@ -226,6 +228,7 @@ Amiga::getConfigItem(ConfigOption option)
         case OPT_AUDPAN1:
         case OPT_AUDPAN2:
         case OPT_AUDPAN3:
+        case OPT_AUDLATENCY:
             return paula.muxer.getConfigItem(option);
 
         case OPT_BLITTER_ACCURACY:
@@ -234,6 +237,9 @@ Amiga::getConfigItem(ConfigOption option)
         case OPT_DRIVE_SPEED:
         case OPT_LOCK_DSKSYNC:
         case OPT_AUTO_DSKSYNC:
+        case OPT_DISK_HLE:
+        case OPT_DISK_HLE_DELAY:
+        case OPT_AUTO_WARP:
             return paula.diskController.getConfigItem(option);
             
         case OPT_SERIAL_DEVICE:
@@ -263,6 +269,7 @@ Amiga::getConfigItem(unsigned dfn, ConfigOption option)
             
         case OPT_DRIVE_TYPE:
         case OPT_EMULATE_MECHANICS:
+        case OPT_FLUSH_INTERVAL:
             return df[dfn]->getConfigItem(option);
             
         default: assert(false);
@@ -751,6 +758,88 @@ Amiga::runLoop()
     }
 }
 
+void
+Amiga::executeFrame()
+{
+    i64 nr = agnus.frame.nr;
+    while (agnus.frame.nr == nr) cpu.execute();
+}
+
+long
+Amiga::renderAudio(long frames, float *left, float *right, long capacity)
+{
+    if (!isPoweredOn()) return 0;
+
+    long count = 0;
+
+    suspend();
+    rendering = true;
+    paula.renderer.begin();
+
+    for (long i = 0; i < frames && count < capacity; i++) {
+
+        executeFrame();
+        count += paula.renderer.synthesize(left + count, right + count,
+                                           capacity - count);
+    }
+
+    rendering = false;
+    restartTimer();
+    resume();
+
+    return count;
+}
+
+bool
+Amiga::renderAudio(long frames, const char *path)
+{
+    if (!isPoweredOn()) return false;
+
+    CaptureFile file;
+    if (!file.open(path, false)) {
+        warn("Failed to create %s\n", path);
+        return false;
+    }
+
+    u32 sampleRate = (u32)paula.muxer.getSampleRate();
+    bool success = file.writeWavHeader(sampleRate, 0);
+
+    const long capacity = 16384;
+    float *left = new float[capacity];
+    float *right = new float[capacity];
+    float *interleaved = new float[2 * capacity];
+
+    suspend();
+    rendering = true;
+    paula.renderer.begin();
+
+    for (long i = 0; i < frames && success; i++) {
+
+        executeFrame();
+        long n = paula.renderer.synthesize(left, right, capacity);
+
+        for (long j = 0; j < n; j++) {
+            interleaved[2 * j] = left[j];
+            interleaved[2 * j + 1] = right[j];
+        }
+        success = file.write(interleaved, 2 * n * sizeof(float));
+    }
+
+    rendering = false;
+    restartTimer();
+    resume();
+
+    delete [] left;
+    delete [] right;
+    delete [] interleaved;
+
+    // Finalize the WAV header
+    if (success) success = file.writeWavHeader(sampleRate, (u32)(file.size() - 44));
+    file.close();
+
+    return success;
+}
+
 void
 Amiga::restartTimer()
 {
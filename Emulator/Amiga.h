@@ -45,6 +45,7 @@
 #include "DMSFile.h"
 #include "EXEFile.h"
 #include "DIRFile.h"
+#include "DiskCache.h"
 #include "FSVolume.h"
 
 /* A complete virtual Amiga. This class is the most prominent one of all. To
@@ -129,6 +130,9 @@ private:
     
     // The invocation counter for implementing suspend() / resume()
     unsigned suspendCounter = 0;
+
+    // Indicates if audio is currently rendered offline (see renderAudio())
+    bool rendering = false;
     
     // The emulator thread
     pthread_t p = NULL;
@@ -270,6 +274,11 @@ public:
     bool inWarpMode() { return warpMode; }
     void enableWarpMode() { setWarp(true); }
     void disableWarpMode() { setWarp(false); }
+    
+    /* Switches warp mode on or off from within the emulator thread. Other
+     * than setWarp(), this function doesn't suspend the emulator.
+     */
+    void switchWarp(bool enable) { HardwareComponent::setWarp(enable); }
 
     void enableDebugMode() { setDebug(true); }
     void disableDebugMode() { setDebug(false); }
@@ -370,6 +379,35 @@ public:
      */
     void runLoop();
 
+
+    //
+    // Rendering audio offline
+    //
+
+public:
+
+    /* Runs the emulator for the specified number of frames and records the
+     * audio output. Emulation takes place in the calling thread as fast as
+     * possible, i.e., without synchronizing to real time. The result does not
+     * depend on warp mode or on the state of the host audio device. If the
+     * emulator is running, it is suspended while rendering.
+     *
+     * The first variant copies the samples into the provided buffers and stops
+     * as soon as 'capacity' samples have been written. It returns the number
+     * of rendered samples. The second variant writes the samples into a WAV
+     * file (32-bit float, stereo) and returns true on success.
+     */
+    long renderAudio(long frames, float *left, float *right, long capacity);
+    bool renderAudio(long frames, const char *path);
+
+    // Indicates if the emulator is currently rendering audio offline
+    bool isRendering() { return rendering; }
+
+private:
+
+    // Emulates a single frame in the calling thread
+    void executeFrame();
+
     
     //
     // Managing emulation speed
@@ -383,6 +421,9 @@ public:
      */
     void restartTimer();
     
+    // Returns the current time in nanoseconds
+    u64 time_in_nanos() { return abs_to_nanos(mach_absolute_time()); }
+
 private:
     
     // Converts kernel time to nanoseconds
@@ -391,9 +432,6 @@ private:
     // Converts nanoseconds to kernel time
     u64 nanos_to_abs(u64 nanos) { return nanos * tb.denom / tb.numer; }
     
-    // Returns the current time in nanoseconds
-    u64 time_in_nanos() { return abs_to_nanos(mach_absolute_time()); }
-    
     /* Returns the delay between two frames in nanoseconds. As long as we only
      * emulate PAL machines, the frame rate is 50 Hz and this function returns
      * a constant.
@@ -62,10 +62,14 @@ typedef VA_ENUM(long, ConfigOption)
     OPT_DRIVE_SPEED,
     OPT_LOCK_DSKSYNC,
     OPT_AUTO_DSKSYNC,
+    OPT_DISK_HLE,
+    OPT_DISK_HLE_DELAY,
+    OPT_AUTO_WARP,
 
     // Drives
     OPT_DRIVE_TYPE,
     OPT_EMULATE_MECHANICS,
+    OPT_FLUSH_INTERVAL,
     
     // Ports
     OPT_SERIAL_DEVICE,
@@ -77,6 +81,10 @@ typedef VA_ENUM(long, ConfigOption)
     OPT_CLX_SPR_SPR,
     OPT_CLX_SPR_PLF,
     OPT_CLX_PLF_PLF,
+
+    // Rendering
+    OPT_RENDER_THREAD,
+    OPT_FRAME_SKIP,
         
     // Blitter
     OPT_BLITTER_ACCURACY,
@@ -101,6 +109,7 @@ typedef VA_ENUM(long, ConfigOption)
     OPT_AUDPAN1,
     OPT_AUDPAN2,
     OPT_AUDPAN3,
+    OPT_AUDLATENCY,
 };
 
 inline bool isConfigOption(long value)
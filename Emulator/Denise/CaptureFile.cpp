@@ -0,0 +1,200 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+CaptureFile::CaptureFile()
+{
+    setDescription("CaptureFile");
+}
+
+CaptureFile::~CaptureFile()
+{
+    close();
+}
+
+bool
+CaptureFile::open(const char *path, bool mapped)
+{
+    assert(!isOpen());
+
+    pos = 0;
+
+    if (mapped) {
+
+        fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1) {
+            warn("Failed to create %s\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        warn("Failed to create %s\n", path);
+        return false;
+    }
+
+    // Replace the default buffer by a large one
+    buffer = new char[bufferSize];
+    setvbuf(file, buffer, _IOFBF, bufferSize);
+    return true;
+}
+
+bool
+CaptureFile::close()
+{
+    bool success = true;
+
+    if (file) {
+
+        bool error = ferror(file);
+        if (fclose(file) != 0 || error) {
+            warn("Failed to flush capture file\n");
+            success = false;
+        }
+        file = NULL;
+    }
+
+    if (fd != -1) {
+
+        if (map && msync(map, capacity, MS_SYNC) == -1) {
+            warn("Failed to flush capture file\n");
+            success = false;
+        }
+        if (map) munmap(map, capacity);
+
+        // Cut off the unused part of the last chunk
+        if (ftruncate(fd, pos) == -1) {
+            warn("Failed to truncate capture file\n");
+            success = false;
+        }
+        ::close(fd);
+
+        fd = -1;
+        map = NULL;
+        capacity = 0;
+    }
+
+    delete[] buffer;
+    buffer = NULL;
+    return success;
+}
+
+bool
+CaptureFile::write(const void *data, size_t count)
+{
+    if (file) {
+
+        if (fwrite(data, 1, count, file) != count) return false;
+        pos += count;
+        return true;
+    }
+
+    if (fd != -1) {
+
+        if (pos + count > capacity && !grow(pos + count)) return false;
+        memcpy(map + pos, data, count);
+        pos += count;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+CaptureFile::patch(size_t offset, const void *data, size_t count)
+{
+    assert(offset + count <= pos);
+
+    if (file) {
+
+        if (fseek(file, (long)offset, SEEK_SET) != 0) return false;
+        bool success = fwrite(data, 1, count, file) == count;
+        fseek(file, 0, SEEK_END);
+        return success;
+    }
+
+    if (fd != -1) {
+
+        memcpy(map + offset, data, count);
+        return true;
+    }
+
+    return false;
+}
+
+bool
+CaptureFile::writeWavHeader(u32 sampleRate, u32 dataSize)
+{
+    const u16 channels = 2;
+    const u16 bitsPerSample = 32;
+    const u32 byteRate = sampleRate * channels * bitsPerSample / 8;
+    const u16 blockAlign = channels * bitsPerSample / 8;
+
+    u8 header[44];
+    u8 *p = header;
+
+    auto write32 = [&](u32 value) { for (int i = 0; i < 4; i++) *p++ = (u8)(value >> (8 * i)); };
+    auto write16 = [&](u16 value) { for (int i = 0; i < 2; i++) *p++ = (u8)(value >> (8 * i)); };
+
+    memcpy(p, "RIFF", 4); p += 4;
+    write32(36 + dataSize);
+    memcpy(p, "WAVE", 4); p += 4;
+
+    // Format chunk (IEEE float)
+    memcpy(p, "fmt ", 4); p += 4;
+    write32(16);
+    write16(3);
+    write16(channels);
+    write32(sampleRate);
+    write32(byteRate);
+    write16(blockAlign);
+    write16(bitsPerSample);
+
+    // Data chunk
+    memcpy(p, "data", 4); p += 4;
+    write32(dataSize);
+    assert(p - header == sizeof(header));
+
+    if (pos == 0) {
+        return write(header, sizeof(header));
+    } else {
+        return patch(0, header, sizeof(header));
+    }
+}
+
+bool
+CaptureFile::grow(size_t required)
+{
+    size_t newCapacity = MAX(2 * capacity, capacity + growSize);
+    while (newCapacity < required) newCapacity += growSize;
+
+    if (map) munmap(map, capacity);
+    map = NULL;
+    capacity = 0;
+
+    if (ftruncate(fd, newCapacity) == -1) {
+        warn("Failed to enlarge capture file\n");
+        return false;
+    }
+
+    void *addr = mmap(NULL, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        warn("Failed to map capture file\n");
+        return false;
+    }
+
+    map = (u8 *)addr;
+    capacity = newCapacity;
+    return true;
+}
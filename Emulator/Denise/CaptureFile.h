@@ -0,0 +1,93 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _CAPTURE_FILE_H
+#define _CAPTURE_FILE_H
+
+#include "AmigaObject.h"
+
+/* An output file for the raw capture sink of the screen recorder. Data is
+ * appended either through a large stdio buffer or, in mapped mode, by copying
+ * it into a memory-mapped view of the file which grows on demand.
+ */
+class CaptureFile : public AmigaObject {
+
+    // Size of the stdio buffer
+    static const size_t bufferSize = 4 * 1024 * 1024;
+
+    // Minimum number of bytes the mapped file grows by
+    static const size_t growSize = 64 * 1024 * 1024;
+
+    // File handle used in buffered mode
+    FILE *file = NULL;
+    char *buffer = NULL;
+
+    // File descriptor and mapped memory used in mapped mode
+    int fd = -1;
+    u8 *map = NULL;
+    size_t capacity = 0;
+
+    // Number of bytes written so far
+    size_t pos = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    CaptureFile();
+    ~CaptureFile();
+
+
+    //
+    // Opening and closing
+    //
+
+public:
+
+    // Creates the file
+    bool open(const char *path, bool mapped);
+
+    // Checks whether the file has been opened successfully
+    bool isOpen() { return file != NULL || fd != -1; }
+
+    // Flushes all data and closes the file. Returns false if data got lost.
+    bool close();
+
+
+    //
+    // Writing
+    //
+
+public:
+
+    // Returns the number of bytes written so far
+    size_t size() { return pos; }
+
+    // Appends data to the end of the file
+    bool write(const void *data, size_t count);
+
+    // Overwrites data that has already been written (e.g., a file header)
+    bool patch(size_t offset, const void *data, size_t count);
+
+    /* Writes or updates the header of a WAV file containing interleaved
+     * stereo samples in 32-bit float format. The header is written if the file
+     * is empty and patched otherwise.
+     */
+    bool writeWavHeader(u32 sampleRate, u32 dataSize);
+
+private:
+
+    // Enlarges the mapped area to hold at least the given number of bytes
+    bool grow(size_t required);
+};
+
+#endif
@@ -16,6 +16,7 @@ Denise::Denise(Amiga& ref) : AmigaComponent(ref)
     
     subComponents = vector<HardwareComponent *> {
         
+        &lineRenderer,
         &pixelEngine,
         &screenRecorder
     };
@@ -26,6 +27,8 @@ Denise::Denise(Amiga& ref) : AmigaComponent(ref)
     config.clxSprSpr = true;
     config.clxSprPlf = true;
     config.clxPlfPlf = true;
+    config.renderThread = false;
+    config.frameSkip = 10;
 }
 
 void
@@ -52,6 +55,8 @@ Denise::getConfigItem(ConfigOption option)
         case OPT_CLX_SPR_SPR:         return config.clxSprSpr;
         case OPT_CLX_SPR_PLF:         return config.clxSprPlf;
         case OPT_CLX_PLF_PLF:         return config.clxPlfPlf;
+        case OPT_RENDER_THREAD:       return config.renderThread;
+        case OPT_FRAME_SKIP:          return config.frameSkip;
             
         default: assert(false);
     }
@@ -138,6 +143,28 @@ Denise::setConfigItem(ConfigOption option, long value)
             config.clxPlfPlf = value;
             return true;
 
+        case OPT_RENDER_THREAD:
+
+            if (config.renderThread == value) {
+                return false;
+            }
+
+            config.renderThread = value;
+            return true;
+
+        case OPT_FRAME_SKIP:
+
+            if (value < 1 || value > 50) {
+                warn("Invalid frame skip value: %d\n", value);
+                return false;
+            }
+            if (config.frameSkip == value) {
+                return false;
+            }
+
+            config.frameSkip = value;
+            return true;
+
         default:
             return false;
     }
@@ -154,6 +181,8 @@ Denise::_dumpConfig()
     msg("         clxSprSpr : %s\n", config.clxSprSpr ? "yes" : "no");
     msg("         clxSprPlf : %s\n", config.clxSprPlf ? "yes" : "no");
     msg("         clxPlfPlf : %s\n", config.clxPlfPlf ? "yes" : "no");
+    msg("      renderThread : %s\n", config.renderThread ? "yes" : "no");
+    msg("         frameSkip : %d\n", config.frameSkip);
 }
 
 void
@@ -181,8 +210,8 @@ Denise::_inspect()
             info.bpldat[i] = bpldat[i];
         }
         for (unsigned i = 0; i < 32; i++) {
-            info.colorReg[i] = pixelEngine.getColor(i);
-            info.color[i] = pixelEngine.getRGBA(i);
+            info.colorReg[i] = colorReg[i];
+            info.color[i] = pixelEngine.colorToRGBA(colorReg[i]);
         }
     }
 }
@@ -254,11 +283,11 @@ Denise::fillShiftRegisters(bool odd, bool even)
         case 1: shiftReg[0] = bpldat[0];
     }
     
-    // On Intel machines, call the optimized SSE code
+    // On Intel machines, call the optimized SSE or AVX2 code
     #if defined(__i386__) || defined(__x86_64__)
     
     if (!NO_SSE) {
-        transposeSSE(shiftReg, slice);
+        transpose(shiftReg, slice);
         return;
     }
     
@@ -297,6 +326,19 @@ Denise::drawOdd(int offset)
     u16 mask = masks[bpu()];
     i16 currentPixel = agnus.ppos() + offset;
     
+    // On Intel machines, synthesize all pixels at once
+    #if defined(__i386__) || defined(__x86_64__)
+    
+    if (!NO_SSE) {
+        assert(currentPixel + (hiresMode ? 16 : 32) <= sizeof(bBuffer));
+        mergeSSE(slice, bBuffer + currentPixel, 0b101010, mask, !hiresMode);
+        armedOdd = false;
+        shiftReg[0] = shiftReg[2] = shiftReg[4] = 0;
+        return;
+    }
+    
+    #endif
+    
     for (int i = 0; i < 16; i++) {
         
         u8 index = slice[i] & mask;
@@ -343,6 +385,19 @@ Denise::drawEven(int offset)
     u16 mask = masks[bpu()];
     i16 currentPixel = agnus.ppos() + offset;
     
+    // On Intel machines, synthesize all pixels at once
+    #if defined(__i386__) || defined(__x86_64__)
+    
+    if (!NO_SSE) {
+        assert(currentPixel + (hiresMode ? 16 : 32) <= sizeof(bBuffer));
+        mergeSSE(slice, bBuffer + currentPixel, 0b010101, mask, !hiresMode);
+        armedEven = false;
+        shiftReg[1] = shiftReg[3] = shiftReg[5] = 0;
+        return;
+    }
+    
+    #endif
+    
     for (int i = 0; i < 16; i++) {
 
         u8 index = slice[i] & mask;
@@ -386,6 +441,19 @@ Denise::drawBoth(int offset)
     u16 mask = masks[bpu()];
     i16 currentPixel = agnus.ppos() + offset;
     
+    // On Intel machines, synthesize all pixels at once
+    #if defined(__i386__) || defined(__x86_64__)
+    
+    if (!NO_SSE) {
+        assert(currentPixel + (hiresMode ? 16 : 32) <= sizeof(bBuffer));
+        mergeSSE(slice, bBuffer + currentPixel, 0, mask, !hiresMode);
+        armedEven = armedOdd = false;
+        for (int i = 0; i < 6; i++) shiftReg[i] = 0;
+        return;
+    }
+    
+    #endif
+    
     for (int i = 0; i < 16; i++) {
         
         u8 index = slice[i] & mask;
@@ -1070,7 +1138,15 @@ Denise::checkP2PCollisions()
 void
 Denise::vsyncHandler()
 {
-    pixelEngine.beginOfFrame();
+    // Wait until the render thread has completed the current frame
+    lineRenderer.drain();
+
+    // Only switch frame buffers if the previous frame has been drawn
+    pixelEngine.beginOfFrame(!skipFrame);
+    
+    // Decide whether the upcoming frame is drawn
+    skipFrame = warpMode && !screenRecorder.isRecording() &&
+    agnus.frame.nr % config.frameSkip != 0;
     
     if (amiga.inDebugMode()) {
         
@@ -1129,18 +1205,10 @@ Denise::endOfLine(int vpos)
 
         // Perform playfield-playfield collision check (if enabled)
         if (config.clxPlfPlf) checkP2PCollisions();
-        
-        // Synthesize RGBA values and write the result into the frame buffer
-        pixelEngine.colorize(vpos);
 
-        // Remove certain graphics layers if requested
-        if (config.hiddenLayers) {
-            pixelEngine.hide(vpos, config.hiddenLayers, config.hiddenLayerAlpha);
-        }
     } else {
         
         drawSprites();
-        pixelEngine.endOfVBlankLine();
     }
 
     assert(sprChanges[0].isEmpty());
@@ -1148,6 +1216,32 @@ Denise::endOfLine(int vpos)
     assert(sprChanges[2].isEmpty());
     assert(sprChanges[3].isEmpty());
 
+    // Only keep track of the color registers if this frame isn't drawn
+    if (skipFrame) {
+        lineRenderer.drain();
+        pixelEngine.endOfVBlankLine();
+        return;
+    }
+    
+    // Let the render thread do the rest if enabled
+    if (config.renderThread) {
+        recordLine(vpos);
+        return;
+    }
+
+    // Wait for the render thread if it has been switched off in this frame
+    lineRenderer.drain();
+
+    if (vpos >= 26) {
+
+        // Synthesize RGBA values and write the result into the frame buffer
+        pixelEngine.renderLine(vpos, config.hiddenLayers, config.hiddenLayerAlpha,
+                               dmaDebugger.isEnabled());
+    } else {
+
+        pixelEngine.endOfVBlankLine();
+    }
+
     // Invoke the DMA debugger
     dmaDebugger.computeOverlay();
     
@@ -1155,6 +1249,37 @@ Denise::endOfLine(int vpos)
     *denise.pixelEngine.pixelAddr(HBLANK_MIN * 4) = hires() ? 0 : -1;
 }
 
+void
+Denise::recordLine(int vpos)
+{
+    LineRecord &record = lineRenderer.claim();
+
+    record.vpos = vpos;
+    record.buffer = pixelEngine.getWorkingBuffer();
+    record.vblank = vpos < 26;
+    record.hires = hires();
+    record.hiddenLayers = config.hiddenLayers;
+    record.hiddenLayerAlpha = config.hiddenLayerAlpha;
+    record.colChanges = pixelEngine.colChanges;
+
+    // Save the pixel buffers
+    if (!record.vblank) {
+        memcpy(record.bBuffer, bBuffer, sizeof(record.bBuffer));
+        memcpy(record.iBuffer, iBuffer, sizeof(record.iBuffer));
+        memcpy(record.mBuffer, mBuffer, sizeof(record.mBuffer));
+        memcpy(record.zBuffer, zBuffer, sizeof(record.zBuffer));
+    }
+
+    // Save the bus usage if the DMA debugger is running
+    record.overlay = dmaDebugger.isEnabled();
+    if (record.overlay) {
+        memcpy(record.busOwner, agnus.busOwner, sizeof(record.busOwner));
+        memcpy(record.busValue, agnus.busValue, sizeof(record.busValue));
+    }
+
+    lineRenderer.commit();
+}
+
 void
 Denise::recordSpriteData(unsigned nr)
 {
@@ -1174,7 +1299,7 @@ Denise::recordSpriteData(unsigned nr)
         spriteInfo[nr].attach = IS_ODD(nr) ? GET_BIT(sprctl[nr], 7) : 0;
         
         for (int i = 0; i < 16; i++) {
-            spriteInfo[nr].colors[i] = pixelEngine.getColor(i + 16);
+            spriteInfo[nr].colors[i] = colorReg[i + 16];
         }
     }
     
@@ -13,6 +13,7 @@
 #include "AmigaComponent.h"
 #include "Colors.h"
 #include "PixelEngine.h"
+#include "LineRenderer.h"
 #include "ScreenRecorder.h"
 
 class Denise : public AmigaComponent {
@@ -40,6 +41,9 @@ class Denise : public AmigaComponent {
     
 public:
     
+    // Feeds the pixel engine from a separate thread (if enabled)
+    LineRenderer lineRenderer = LineRenderer(amiga);
+
     // Color synthesizer for computing RGBA values
     PixelEngine pixelEngine = PixelEngine(amiga);
 
@@ -53,6 +57,13 @@ public:
     
     // Denise has been executed up to this clock cycle
     Cycle clock = 0;
+    
+    /* Indicates if the current frame is drawn. In warp mode, the pixel
+     * synthesis stages are skipped for all frames but every n-th frame. The
+     * stages affecting the emulated machine (bitplane translation, sprite
+     * drawing, collision detection) are executed in all frames.
+     */
+    bool skipFrame = false;
 
 
     //
@@ -80,6 +91,12 @@ public:
     u16 clxdat;
     u16 clxcon;
 
+    /* Color registers as seen by the emulator thread. The pixel engine keeps
+     * its own copy which is updated line by line, possibly by the render
+     * thread. This copy is updated immediately when a register is written.
+     */
+    u16 colorReg[32];
+
     /* Parallel-to-serial shift registers. Denise transfers the current values
      * of the BPLDAT registers into these shift registers after BPLDAT1 is
      * written to. This is emulated in function fillShiftRegister().
@@ -355,6 +372,7 @@ private:
         & bpldat
         & clxdat
         & clxcon
+        & colorReg
         & shiftReg
         & armedEven
         & armedOdd
@@ -468,6 +486,7 @@ public:
 
     // COLORxx
     template <Accessor s, int xx> void pokeCOLORxx(u16 value);
+    template <Accessor s> void pokeCOLOR(int xx, u16 value);
 
     
     //
@@ -582,6 +601,9 @@ public:
     // Called by Agnus at the end of a rasterline
     void endOfLine(int vpos);
 
+    // Hands the current rasterline over to the render thread
+    void recordLine(int vpos);
+
     // Called by Agnus if the DMACON register changes
     void pokeDMACON(u16 oldValue, u16 newValue);
 
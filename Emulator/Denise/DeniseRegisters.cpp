@@ -273,6 +273,13 @@ Denise::pokeSPRxDATB(u16 value)
 template <Accessor s, int xx> void
 Denise::pokeCOLORxx(u16 value)
 {
+    pokeCOLOR<s>(xx, value);
+}
+
+template <Accessor s> void
+Denise::pokeCOLOR(int xx, u16 value)
+{
+    assert(xx < 32);
     trace(COLREG_DEBUG, "pokeCOLOR%02d(%X)\n", xx, value);
 
     u32 reg = 0x180 + 2*xx;
@@ -283,8 +290,12 @@ Denise::pokeCOLORxx(u16 value)
     
     // Record the color change
     pixelEngine.colChanges.insert(4 * pos, RegChange { reg, value } );
+    colorReg[xx] = value & 0xFFF;
 }
 
+template void Denise::pokeCOLOR<CPU_ACCESS>(int xx, u16 value);
+template void Denise::pokeCOLOR<AGNUS_ACCESS>(int xx, u16 value);
+
 template void Denise::pokeBPLxDAT<0,CPU_ACCESS>(u16 value);
 template void Denise::pokeBPLxDAT<0,AGNUS_ACCESS>(u16 value);
 template void Denise::pokeBPLxDAT<1,CPU_ACCESS>(u16 value);
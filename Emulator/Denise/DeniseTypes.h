@@ -41,6 +41,53 @@ inline const char *sDeniseRevision(DeniseRevision value)
     }
 }
 
+typedef VA_ENUM(long, RecordingPolicy)
+{
+    REC_DROP_FRAMES,     // Skip frames if the encoder falls behind
+    REC_BLOCK,           // Wait for the encoder if it falls behind
+    REC_POLICY_COUNT
+};
+
+inline bool isRecordingPolicy(long value)
+{
+    return value >= 0 && value < REC_POLICY_COUNT;
+}
+
+typedef VA_ENUM(long, RecordingSink)
+{
+    REC_SINK_FFMPEG,     // Encode with FFmpeg
+    REC_SINK_RAW,        // Write raw Y4M and WAV files
+    REC_SINK_COUNT
+};
+
+inline bool isRecordingSink(long value)
+{
+    return value >= 0 && value < REC_SINK_COUNT;
+}
+
+typedef VA_ENUM(long, VideoFormat)
+{
+    VIDEO_RGBA,          // 32-bit RGBA (converted by FFmpeg)
+    VIDEO_YUV420P,       // Planar YUV 4:2:0
+    VIDEO_NV12,          // Semi-planar YUV 4:2:0 (interleaved chroma)
+    VIDEO_FORMAT_COUNT
+};
+
+inline bool isVideoFormat(long value)
+{
+    return value >= 0 && value < VIDEO_FORMAT_COUNT;
+}
+
+inline const char *sVideoFormat(VideoFormat value)
+{
+    switch (value) {
+        case VIDEO_RGBA:     return "rgba";
+        case VIDEO_YUV420P:  return "yuv420p";
+        case VIDEO_NV12:     return "nv12";
+        default:             return "???";
+    }
+}
+
 typedef VA_ENUM(long, Palette)
 {
     PALETTE_COLOR = 0,
@@ -66,9 +113,25 @@ typedef struct
 {
     u32 *data;
     bool longFrame;
+
+    // Bitmap marking the lines that differ from the previous frame
+    u64 *dirty;
 }
 ScreenBuffer;
 
+typedef struct
+{
+    // Number of frames handed over to the writer thread
+    long queued;
+
+    // Number of frames skipped because the frame queue was full
+    long dropped;
+
+    // Number of frames written to FFmpeg
+    long written;
+}
+RecorderStats;
+
 typedef struct
 {
     // Number of lines the sprite was armed
@@ -110,6 +173,12 @@ typedef struct
 
     // Checks for playfield-playfield collisions
     bool clxPlfPlf;
+
+    // Colorizes rasterlines on a separate thread
+    bool renderThread;
+    
+    // In warp mode, only every n-th frame is drawn (1 = draw all frames)
+    long frameSkip;
 }
 DeniseConfig;
 
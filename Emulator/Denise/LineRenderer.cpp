@@ -0,0 +1,161 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+
+LineRenderer::LineRenderer(Amiga& ref) : AmigaComponent(ref)
+{
+    setDescription("LineRenderer");
+
+    records = new LineRecord[capacity];
+    r = 0;
+    w = 0;
+    sleeping = false;
+    quit = false;
+}
+
+LineRenderer::~LineRenderer()
+{
+    terminate();
+    delete[] records;
+}
+
+void
+LineRenderer::_reset(bool hard)
+{
+    RESET_SNAPSHOT_ITEMS(hard)
+
+    drain();
+}
+
+void
+LineRenderer::_powerOff()
+{
+    drain();
+    terminate();
+}
+
+void
+LineRenderer::_pause()
+{
+    drain();
+}
+
+void
+LineRenderer::launch()
+{
+    if (renderThread.joinable()) return;
+
+    debug(RUN_DEBUG, "Launching render thread\n");
+
+    quit = false;
+    renderThread = std::thread(&LineRenderer::main, this);
+}
+
+void
+LineRenderer::terminate()
+{
+    if (!renderThread.joinable()) return;
+
+    debug(RUN_DEBUG, "Terminating render thread\n");
+
+    {   std::lock_guard<std::mutex> lock(sleepMutex);
+        quit = true;
+    }
+    wakeUp.notify_one();
+    renderThread.join();
+}
+
+void
+LineRenderer::main()
+{
+    while (true) {
+
+        int pos = r.load(std::memory_order_relaxed);
+
+        // Go to sleep if there is nothing to do
+        if (pos == w.load(std::memory_order_acquire)) {
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping = true;
+            wakeUp.wait(lock, [&]{ return quit || pos != w.load(); });
+            sleeping = false;
+
+            if (quit) break;
+            continue;
+        }
+
+        // Process the oldest record and release its slot
+        render(records[pos]);
+        r.store((pos + 1) % capacity, std::memory_order_release);
+    }
+}
+
+void
+LineRenderer::render(LineRecord &record)
+{
+    u32 *dst = record.buffer->data + record.vpos * HPIXELS;
+
+    if (record.vblank) {
+
+        // Only keep track of the color registers
+        pixelEngine.endOfVBlankLine(record.colChanges);
+
+    } else {
+
+        // Synthesize RGBA values
+        pixelEngine.renderLine(record.buffer, record.vpos,
+                               record.bBuffer, record.iBuffer,
+                               record.mBuffer, record.zBuffer,
+                               record.colChanges,
+                               record.hiddenLayers, record.hiddenLayerAlpha,
+                               record.overlay);
+    }
+
+    // Superimpose the DMA debugger output
+    if (record.overlay) {
+        dmaDebugger.computeOverlay(dst, record.busOwner, record.busValue);
+    }
+
+    // Encode a HIRES / LORES marker in the first HBLANK pixel
+    dst[HBLANK_MIN * 4] = record.hires ? 0 : -1;
+}
+
+LineRecord &
+LineRenderer::claim()
+{
+    launch();
+
+    int pos = w.load(std::memory_order_relaxed);
+    int next = (pos + 1) % capacity;
+
+    // Wait until the render thread has freed a slot
+    while (next == r.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    return records[pos];
+}
+
+void
+LineRenderer::commit()
+{
+    int pos = w.load(std::memory_order_relaxed);
+    w.store((pos + 1) % capacity);
+
+    // Wake up the render thread if it has fallen asleep
+    if (sleeping.load()) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+}
+
+void
+LineRenderer::drain()
+{
+    while (!isEmpty()) std::this_thread::yield();
+}
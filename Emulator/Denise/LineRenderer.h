@@ -0,0 +1,177 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _LINE_RENDERER_H
+#define _LINE_RENDERER_H
+
+#include "AmigaComponent.h"
+#include <atomic>
+#include <condition_variable>
+
+/* All data needed to synthesize the RGBA values of a single rasterline.
+ * The record is filled by Denise at the end of each line and processed by
+ * the render thread afterwards.
+ */
+struct LineRecord {
+
+    // The rasterline this record belongs to
+    i16 vpos;
+
+    // The frame buffer the rasterline is drawn into
+    ScreenBuffer *buffer;
+
+    // Indicates if the line belongs to the VBLANK area
+    bool vblank;
+
+    // Indicates if the line has been drawn in hires mode
+    bool hires;
+
+    // Layer masking parameters (see PixelEngine::hide())
+    u16 hiddenLayers;
+    u8 hiddenLayerAlpha;
+
+    // Indicates if the DMA debugger overlay is drawn on top
+    bool overlay;
+
+    // Snapshot of Denise's pixel buffers
+    u8 bBuffer[HPIXELS];
+    u8 iBuffer[HPIXELS];
+    u8 mBuffer[HPIXELS];
+    u16 zBuffer[HPIXELS];
+
+    // Color register and BPLCON0 changes that happened in this line
+    RegChangeRecorder<128> colChanges;
+
+    // Snapshot of the bus usage (only recorded if the DMA debugger is active)
+    BusOwner busOwner[HPOS_CNT];
+    u16 busValue[HPOS_CNT];
+};
+
+/* The line renderer moves the final stage of the graphics pipeline to a
+ * separate thread. At the end of each rasterline, Denise stores all data
+ * that is required to colorize the line in a line record and hands it over
+ * via a single-producer, single-consumer ring buffer. The render thread
+ * picks up the record and runs the pixel engine and the DMA debugger on it.
+ *
+ * All stages that have a visible effect on the emulated machine (bitplane
+ * translation, sprite drawing, collision detection) are still executed
+ * by the emulator thread. The render thread only writes into the working
+ * frame buffer and the color state of the pixel engine. Both are handed
+ * back to the emulator thread by calling drain().
+ */
+class LineRenderer : public AmigaComponent {
+
+    // Number of line records in the ring buffer
+    static const int capacity = 64;
+
+    // The ring buffer
+    LineRecord *records;
+
+    // Read and write pointers
+    std::atomic<int> r;
+    std::atomic<int> w;
+
+    // The render thread
+    std::thread renderThread;
+
+    // Synchronization primitives for putting the render thread to sleep
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<bool> sleeping;
+
+    // Indicates if the render thread is supposed to terminate
+    std::atomic<bool> quit;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    LineRenderer(Amiga& ref);
+    ~LineRenderer();
+
+    void _reset(bool hard) override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    template <class T>
+    void applyToPersistentItems(T& worker)
+    {
+    }
+
+    template <class T>
+    void applyToHardResetItems(T& worker)
+    {
+    }
+
+    template <class T>
+    void applyToResetItems(T& worker)
+    {
+    }
+
+    size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
+    size_t _load(u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
+    size_t _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    size_t willLoadFromBuffer(u8 *buffer) override { drain(); return 0; }
+    size_t willSaveToBuffer(u8 *buffer) override { drain(); return 0; }
+
+
+    //
+    // Controlling
+    //
+
+private:
+
+    void _powerOff() override;
+    void _pause() override;
+
+
+    //
+    // Managing the render thread
+    //
+
+private:
+
+    void launch();
+    void terminate();
+
+    // Main loop of the render thread
+    void main();
+
+    // Processes a single line record
+    void render(LineRecord &record);
+
+
+    //
+    // Feeding the render thread
+    //
+
+public:
+
+    // Checks whether unprocessed line records are pending
+    bool isEmpty() { return r.load() == w.load(); }
+
+    // Returns the next free record (blocks if the ring buffer is full)
+    LineRecord &claim();
+
+    // Hands the claimed record over to the render thread
+    void commit();
+
+    // Waits until all pending line records have been processed
+    void drain();
+};
+
+#endif
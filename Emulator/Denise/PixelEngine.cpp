@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "SSEUtils.h"
 
 PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 {
@@ -16,6 +17,10 @@ PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
     // Allocate frame buffers
     emuTexture[0].data = new u32[PIXELS]; emuTexture[0].longFrame = true;
     emuTexture[1].data = new u32[PIXELS]; emuTexture[1].longFrame = true;
+    emuTexture[0].dirty = dirtyLines[0];
+    emuTexture[1].dirty = dirtyLines[1];
+    memset(dirtyLines, 0xFF, sizeof(dirtyLines));
+    clearFingerprints();
     
     // Create random background noise pattern
     const size_t noiseSize = 2 * 512 * 512;
@@ -65,6 +70,7 @@ PixelEngine::_powerOn()
             emuTexture[1].data[pos] = col;
         }
     }
+    clearFingerprints();
 }
 
 void
@@ -140,6 +146,9 @@ PixelEngine::updateRGBA()
 
     // Update all RGBA values that are cached in indexedRgba[]
     for (int i = 0; i < 32; i++) setColor(i, colreg[i]);
+
+    // Lines from previous frames have been drawn with the old values
+    clearFingerprints();
 }
 
 void
@@ -260,11 +269,20 @@ PixelEngine::pixelAddr(int pixel)
 }
 
 void
-PixelEngine::beginOfFrame()
+PixelEngine::beginOfFrame(bool swap)
 {
-    // Switch the working buffer
-    synchronized {
-        frameBuffer = (frameBuffer == &emuTexture[0]) ? &emuTexture[1] : &emuTexture[0];
+    if (swap) {
+        
+        // Switch the working buffer
+        synchronized {
+            frameBuffer = (frameBuffer == &emuTexture[0]) ? &emuTexture[1] : &emuTexture[0];
+            frameBuffer->longFrame = agnus.frame.lof;
+            memset(frameBuffer->dirty, 0, sizeof(dirtyLines[0]));
+        }
+        
+    } else {
+        
+        // Keep the working buffer if the previous frame hasn't been drawn
         frameBuffer->longFrame = agnus.frame.lof;
     }
     
@@ -273,10 +291,16 @@ PixelEngine::beginOfFrame()
 
 void
 PixelEngine::endOfVBlankLine()
+{
+    endOfVBlankLine(colChanges);
+}
+
+void
+PixelEngine::endOfVBlankLine(RegChangeRecorder<128> &changes)
 {
     // Apply all color register changes that happened in this line
-    for (int i = colChanges.begin(); i != colChanges.end(); i = colChanges.next(i)) {
-        applyRegisterChange(colChanges.elements[i]);
+    for (int i = changes.begin(); i != changes.end(); i = changes.next(i)) {
+        applyRegisterChange(changes.elements[i]);
     }
 }
 
@@ -300,29 +324,148 @@ PixelEngine::applyRegisterChange(const RegChange &change)
 }
 
 void
-PixelEngine::colorize(int line)
+PixelEngine::renderLine(int line, u16 layers, u8 alpha, bool overlay)
+{
+    renderLine(frameBuffer, line,
+               denise.bBuffer, denise.iBuffer, denise.mBuffer, denise.zBuffer,
+               colChanges, layers, alpha, overlay);
+}
+
+void
+PixelEngine::renderLine(ScreenBuffer *buffer, int line,
+                        u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                        RegChangeRecorder<128> &changes,
+                        u16 layers, u8 alpha, bool overlay)
+{
+    assert(line < VPIXELS);
+
+    int nr = buffer == &emuTexture[0] ? 0 : 1;
+    u32 *dst = buffer->data + line * HPIXELS;
+    u32 *prv = emuTexture[nr ^ 1].data + line * HPIXELS;
+
+    // Fingerprint the input data (lines with a DMA overlay are never reused)
+    u64 fp = overlay ? 0 : computeFingerprint(bbuf, ibuf, mbuf, zbuf,
+                                              changes, layers, alpha);
+
+    // Mark the line as dirty if it differs from the previous frame
+    if (!fp || fp != fingerprint[nr ^ 1][line]) {
+        buffer->dirty[line >> 6] |= 1ULL << (line & 63);
+    }
+
+    if (fp && fp == fingerprint[nr][line]) {
+
+        // The line has been drawn with the same data two frames ago
+        endOfVBlankLine(changes);
+
+    } else if (fp && fp == fingerprint[nr ^ 1][line]) {
+
+        // The line has been drawn with the same data in the previous frame
+        memcpy(dst, prv, HPIXELS * sizeof(u32));
+        endOfVBlankLine(changes);
+
+    } else {
+
+        // Synthesize RGBA values
+        colorize(dst, bbuf, ibuf, mbuf, zbuf, changes);
+
+        // Remove certain graphics layers if requested
+        if (layers) hide(dst, line, zbuf, layers, alpha);
+    }
+
+    fingerprint[nr][line] = fp;
+}
+
+/* Runs a word-wise variant of the FNV-1a algorithm over a buffer. To speed
+ * things up, four independent hash values are computed in parallel and
+ * merged at the end.
+ */
+static u64
+hashBuffer(u64 hash, const u8 *addr, size_t size)
+{
+    u64 h[4] = { hash, hash + 1, hash + 2, hash + 3 };
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        for (int j = 0; j < 4; j++) {
+            u64 word; memcpy(&word, addr + i + 8 * j, 8);
+            h[j] = fnv_1a_it64(h[j], word);
+        }
+    }
+    for (; i < size; i++) {
+        h[0] = fnv_1a_it64(h[0], addr[i]);
+    }
+
+    return fnv_1a_it64(fnv_1a_it64(fnv_1a_it64(h[0], h[1]), h[2]), h[3]);
+}
+
+u64
+PixelEngine::computeFingerprint(u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                                RegChangeRecorder<128> &changes,
+                                u16 layers, u8 alpha)
+{
+    u64 hash = fnv_1a_init64();
+    bool ham = hamMode;
+
+    // Hash the color registers as they are at the beginning of the line
+    for (int i = 0; i < 32; i += 4) {
+        hash = fnv_1a_it64(hash, (u64)colreg[i] << 48 | (u64)colreg[i+1] << 32 |
+                                 (u64)colreg[i+2] << 16 | colreg[i+3]);
+    }
+    hash = fnv_1a_it64(hash, (u64)hamMode << 32 | layers << 8 | alpha);
+
+    // Hash all register changes
+    for (int i = changes.begin(); i != changes.end(); i = changes.next(i)) {
+
+        RegChange &change = changes.elements[i];
+        if (change.addr == BPLCON0) ham = true;
+
+        hash = fnv_1a_it64(hash, changes.keys[i]);
+        hash = fnv_1a_it64(hash, (u64)change.addr << 16 | change.value);
+    }
+
+    // Hash the pixel data that is processed by the colorizer
+    hash = hashBuffer(hash, mbuf, HPIXELS);
+    if (ham) {
+        hash = hashBuffer(hash, bbuf, HPIXELS);
+        hash = hashBuffer(hash, ibuf, HPIXELS);
+    }
+    if (ham || layers) {
+        hash = hashBuffer(hash, (u8 *)zbuf, HPIXELS * sizeof(u16));
+    }
+
+    // 0 is reserved for lines without a fingerprint
+    return hash ? hash : 1;
+}
+
+void
+PixelEngine::clearFingerprints()
+{
+    memset(fingerprint, 0, sizeof(fingerprint));
+}
+
+void
+PixelEngine::colorize(u32 *dst, u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                      RegChangeRecorder<128> &changes)
 {
-    // Jump to the first pixel in the specified line in the active frame buffer
-    u32 *dst = frameBuffer->data + line * HPIXELS;
     int pixel = 0;
 
     // Initialize the HAM mode hold register with the current background color
     u16 hold = colreg[0];
 
     // Add a dummy register change to ensure we draw until the line end
-    colChanges.insert(HPIXELS, RegChange { SET_NONE, 0 } );
+    changes.insert(HPIXELS, RegChange { SET_NONE, 0 } );
 
     // Iterate over all recorded register changes
-    for (int i = colChanges.begin(); i != colChanges.end(); i = colChanges.next(i)) {
+    for (int i = changes.begin(); i != changes.end(); i = changes.next(i)) {
 
-        Cycle trigger = colChanges.keys[i];
-        RegChange &change = colChanges.elements[i];
+        Cycle trigger = changes.keys[i];
+        RegChange &change = changes.elements[i];
 
         // Colorize a chunk of pixels
         if (hamMode) {
-            colorizeHAM(dst, pixel, trigger, hold);
+            colorizeHAM(dst, bbuf, ibuf, mbuf, zbuf, pixel, trigger, hold);
         } else {
-            colorize(dst, pixel, trigger);
+            colorize(dst, mbuf, pixel, trigger);
         }
         pixel = trigger;
 
@@ -336,13 +479,21 @@ PixelEngine::colorize(int line)
     }
 
     // Clear the history cache
-    colChanges.clear();
+    changes.clear();
 }
 
 void
-PixelEngine::colorize(u32 *dst, int from, int to)
+PixelEngine::colorize(u32 *dst, u8 *mbuf, int from, int to)
 {
-    u8 *mbuf = denise.mBuffer;
+    // On Intel machines, translate multiple pixels at once if possible
+    #if defined(__i386__) || defined(__x86_64__)
+
+    if (!NO_SSE && hasAVX2()) {
+        if (to > from) colorizeAVX2(mbuf + from, dst + from, indexedRgba, to - from);
+        return;
+    }
+
+    #endif
 
     for (int i = from; i < to; i++) {
         dst[i] = indexedRgba[mbuf[i]];
@@ -350,11 +501,22 @@ PixelEngine::colorize(u32 *dst, int from, int to)
 }
 
 void
-PixelEngine::colorizeHAM(u32 *dst, int from, int to, u16& ham)
+PixelEngine::colorizeHAM(u32 *dst, u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                         int from, int to, u16& ham)
 {
-    u8 *bbuf = denise.bBuffer;
-    u8 *ibuf = denise.iBuffer;
-    u8 *mbuf = denise.mBuffer;
+    // On Intel machines, resolve the hold-and-modify chain in parallel
+    #if defined(__i386__) || defined(__x86_64__)
+
+    if (!NO_SSE && hasAVX2()) {
+        if (to > from) {
+            colorizeHAMAVX2(bbuf + from, ibuf + from, mbuf + from,
+                            zbuf + from, colreg, rgba, indexedRgba,
+                            Denise::Z_SP01234567, dst + from, to - from, ham);
+        }
+        return;
+    }
+
+    #endif
 
     for (int i = from; i < to; i++) {
 
@@ -392,7 +554,7 @@ PixelEngine::colorizeHAM(u32 *dst, int from, int to, u16& ham)
         }
 
         // Synthesize pixel
-        if (denise.spritePixelIsVisible(i)) {
+        if (Denise::isSpritePixel(zbuf[i])) {
             dst[i] = rgba[colreg[mbuf[i]]];
         } else {
             dst[i] = rgba[ham];
@@ -401,13 +563,11 @@ PixelEngine::colorizeHAM(u32 *dst, int from, int to, u16& ham)
 }
 
 void
-PixelEngine::hide(int line, u16 layers, u8 alpha)
+PixelEngine::hide(u32 *p, int line, u16 *zbuf, u16 layers, u8 alpha)
 {
-    u32 *p = frameBuffer->data + line * HPIXELS;
-
     for (int i = 0; i < HPIXELS; i++) {
 
-        u16 z = denise.zBuffer[i];
+        u16 z = zbuf[i];
 
         // Check for case 1: A sprite is visible
         if (Denise::isSpritePixel(z)) {
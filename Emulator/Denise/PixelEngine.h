@@ -43,6 +43,23 @@ private:
     u32 *noise;
 
     
+    //
+    // Dirty line detection
+    //
+
+    /* For each line in both screen buffers, the emulator keeps a fingerprint
+     * of the data the line has been computed from. If a line is drawn with
+     * the same input again, the RGBA values are taken over from the previous
+     * frame. A value of 0 indicates that the line has no valid fingerprint.
+     */
+    u64 fingerprint[2][VPIXELS];
+
+    /* Bitmaps marking all lines that differ from the previous frame. They
+     * are handed out to the GUI as part of the ScreenBuffer struct.
+     */
+    u64 dirtyLines[2][(VPIXELS + 63) / 64];
+
+    
     //
     // Color management
     //
@@ -170,6 +187,9 @@ public:
     u16 getColor(int nr) { assert(nr < 32); return colreg[nr]; }
     u32 getRGBA(int nr) { assert(nr < 32); return indexedRgba[nr]; }
 
+    // Translates a color value in Amiga format to RGBA format
+    u32 colorToRGBA(u16 value) { return rgba[value & 0xFFF]; }
+
     // Returns sprite color in Amiga format or RGBA format
     u16 getSpriteColor(int s, int nr) { assert(s < 8); return getColor(16 + nr + 2 * (s & 6)); }
     u32 getSpriteRGBA(int s, int nr) { return rgba[getSpriteColor(s,nr)]; }
@@ -205,9 +225,33 @@ public:
 
     // Called after each line in the VBLANK area
     void endOfVBlankLine();
+    void endOfVBlankLine(RegChangeRecorder<128> &changes);
 
-    // Called after each frame to switch the frame buffers
-    void beginOfFrame();
+    // Returns the current working buffer
+    ScreenBuffer *getWorkingBuffer() { return frameBuffer; }
+
+    // Called after each frame to switch the frame buffers (if requested)
+    void beginOfFrame(bool swap = true);
+
+
+    //
+    // Detecting dirty lines
+    //
+
+public:
+
+    // Checks whether a line of a frame buffer differs from the previous frame
+    static bool isDirty(const ScreenBuffer &buffer, int line) {
+        return buffer.dirty[line >> 6] & (1ULL << (line & 63)); }
+
+private:
+
+    // Computes the fingerprint of a rasterline
+    u64 computeFingerprint(u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                           RegChangeRecorder<128> &changes, u16 layers, u8 alpha);
+
+    // Deletes all fingerprints
+    void clearFingerprints();
 
 
     //
@@ -225,18 +269,32 @@ public:
     //
 
 public:
-    
+
+    /* Synthesizes a rasterline.
+     * This function runs colorize() and hide() on a rasterline of the given
+     * frame buffer. Both stages are skipped if the line has been computed
+     * from the same data in one of the previous two frames. Lines that are
+     * superimposed by the DMA debugger are always recomputed.
+     */
+    void renderLine(int line, u16 layers, u8 alpha, bool overlay);
+    void renderLine(ScreenBuffer *buffer, int line,
+                    u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                    RegChangeRecorder<128> &changes,
+                    u16 layers, u8 alpha, bool overlay);
+
     /* Colorizes a rasterline.
      * This function implements the last stage in the emulator's graphics
      * pipelile. It translates a line of color register indices into a line
      * of RGBA values in GPU format.
      */
-    void colorize(int line);
-    
+    void colorize(u32 *dst, u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                  RegChangeRecorder<128> &changes);
+
 private:
     
-    void colorize(u32 *dst, int from, int to);
-    void colorizeHAM(u32 *dst, int from, int to, u16& ham);
+    void colorize(u32 *dst, u8 *mbuf, int from, int to);
+    void colorizeHAM(u32 *dst, u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                     int from, int to, u16& ham);
     
     /* Hides some graphics layers.
      * This function is an optional stage applied after colorize(). It can
@@ -245,7 +303,7 @@ private:
     
 public:
     
-    void hide(int line, u16 layer, u8 alpha);
+    void hide(u32 *dst, int line, u16 *zbuf, u16 layer, u8 alpha);
 };
 
 #endif
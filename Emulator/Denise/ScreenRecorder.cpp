@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "SSEUtils.h"
 #include <fcntl.h>
 
 ScreenRecorder::ScreenRecorder(Amiga& ref) : AmigaComponent(ref)
@@ -20,6 +21,34 @@ ScreenRecorder::ScreenRecorder(Amiga& ref) : AmigaComponent(ref)
     };
     
     muxer.setDescription("RecMuxer");
+    capturePath = strdup("/tmp/capture");
+
+    for (int i = 0; i < queueSize; i++) {
+        frames[i].video = NULL;
+        frames[i].audio = NULL;
+    }
+    r = 0;
+    w = 0;
+    sleeping = false;
+    quit = false;
+    failed = false;
+    full = false;
+    clearStats();
+}
+
+ScreenRecorder::~ScreenRecorder()
+{
+    // Terminate the writer thread if a recording is still in progress
+    if (writer.joinable()) {
+
+        {   std::lock_guard<std::mutex> lock(sleepMutex);
+            quit = true;
+        }
+        wakeUp.notify_one();
+        writer.join();
+    }
+    freeFrames();
+    free(capturePath);
 }
 
 bool
@@ -32,6 +61,17 @@ void
 ScreenRecorder::_reset(bool hard)
 {
     RESET_SNAPSHOT_ITEMS(hard)
+
+    // Reconnect to Paula's samplers in the next frame
+    audioClock = 0;
+}
+
+size_t
+ScreenRecorder::didLoadFromBuffer(u8 *buffer)
+{
+    // Reconnect to Paula's samplers in the next frame
+    audioClock = 0;
+    return 0;
 }
 
 void
@@ -40,6 +80,91 @@ ScreenRecorder::_dump()
     msg("%s:%s installed\n", ffmpegPath(), hasFFmpeg() ? "" : " not");
     msg("Video pipe:%s created\n", videoPipe != -1 ? "" : " not");
     msg("Audio pipe:%s created\n", audioPipe != -1 ? "" : " not");
+    msg("Frame queue: %d / %d\n", (w - r + queueSize) % queueSize, queueSize);
+    msg("     Policy: %s\n", policy == REC_BLOCK ? "Block" : "Drop frames");
+    msg("     Format: %s\n", sVideoFormat(streamFormat()));
+    msg("       Sink: %s\n", sink == REC_SINK_RAW ? capturePath : "FFmpeg");
+    msg("     Queued: %ld\n", queued.load());
+    msg("    Dropped: %ld\n", dropped.load());
+    msg("    Written: %ld\n", written.load());
+}
+
+RecorderStats
+ScreenRecorder::getStats()
+{
+    RecorderStats result;
+
+    result.queued = queued;
+    result.dropped = dropped;
+    result.written = written;
+
+    return result;
+}
+
+void
+ScreenRecorder::clearStats()
+{
+    queued = 0;
+    dropped = 0;
+    written = 0;
+}
+
+void
+ScreenRecorder::setPolicy(RecordingPolicy value)
+{
+    if (!isRecordingPolicy(value)) {
+        warn("Invalid recording policy: %d\n", value);
+        return;
+    }
+
+    policy = value;
+}
+
+bool
+ScreenRecorder::setSink(RecordingSink value)
+{
+    if (!isRecordingSink(value)) {
+        warn("Invalid recording sink: %d\n", value);
+        return false;
+    }
+    if (isRecording()) {
+        warn("Can't change the recording sink while recording\n");
+        return false;
+    }
+
+    sink = value;
+    return true;
+}
+
+bool
+ScreenRecorder::setPath(const char *path)
+{
+    assert(path != NULL);
+
+    if (isRecording()) {
+        warn("Can't change the capture path while recording\n");
+        return false;
+    }
+
+    free(capturePath);
+    capturePath = strdup(path);
+    return true;
+}
+
+bool
+ScreenRecorder::setFormat(VideoFormat value)
+{
+    if (!isVideoFormat(value)) {
+        warn("Invalid video format: %d\n", value);
+        return false;
+    }
+    if (isRecording()) {
+        warn("Can't change the video format while recording\n");
+        return false;
+    }
+
+    format = value;
+    return true;
 }
     
 bool
@@ -50,6 +175,52 @@ ScreenRecorder::startRecording(int x1, int y1, int x2, int y2,
 {
     if (isRecording()) return false;
 
+    synchronized {
+
+        // Make sure the screen dimensions are even
+        if ((x2 - x1) % 2) x2--;
+        if ((y2 - y1) % 2) y2--;
+        cutout.x1 = x1;
+        cutout.x2 = x2;
+        cutout.y1 = y1;
+        cutout.y2 = y2;
+        debug("Recorded area: (%d,%d) - (%d,%d)\n", x1, y1, x2, y2);
+
+        // Start the audio track in the next frame
+        audioClock = 0;
+
+        // Setup the frame queue
+        frameSize = sizeof(u32) * (x2 - x1) * (y2 - y1);
+        allocateFrames(frameSize, 2 * samplesPerFrame);
+        clearStats();
+
+        // Connect to the selected sink
+        if (sink == REC_SINK_RAW) {
+            recording = openCaptureFiles(aspectX, aspectY);
+        } else {
+            recording = launchFFmpeg(bitRate, aspectX, aspectY);
+        }
+
+        // Launch the writer thread
+        if (recording) {
+            quit = false;
+            failed = false;
+            full = false;
+            writer = std::thread(&ScreenRecorder::main, this);
+        }
+    }
+
+    if (isRecording()) {
+        messageQueue.put(MSG_RECORDING_STARTED);
+        return true;
+    }
+    
+    return false;
+}
+
+bool
+ScreenRecorder::launchFFmpeg(long bitRate, long aspectX, long aspectY)
+{
     // Create pipes
     debug(REC_DEBUG, "Creating pipes...\n");
 
@@ -61,111 +232,132 @@ ScreenRecorder::startRecording(int x1, int y1, int x2, int y2,
     debug(REC_DEBUG, "Pipes created\n");
     dump();
     
-    synchronized {
+    //
+    // Assemble the command line arguments for the video encoder
+    //
+    
+    char cmd1[512]; char *ptr = cmd1;
 
-        // Make sure the screen dimensions are even
-        if ((x2 - x1) % 2) x2--;
-        if ((y2 - y1) % 2) y2--;
-        cutout.x1 = x1;
-        cutout.x2 = x2;
-        cutout.y1 = y1;
-        cutout.y2 = y2;
-        debug("Recorded area: (%d,%d) - (%d,%d)\n", x1, y1, x2, y2);
-          
-        //
-        // Assemble the command line arguments for the video encoder
-        //
-        
-        char cmd1[512]; char *ptr = cmd1;
+    // Path to the FFmpeg executable
+    ptr += sprintf(ptr, "%s -nostdin", ffmpegPath());
 
-        // Path to the FFmpeg executable
-        ptr += sprintf(ptr, "%s -nostdin", ffmpegPath());
+    // Verbosity
+    ptr += sprintf(ptr, " -loglevel %s", loglevel());
 
-        // Verbosity
-        ptr += sprintf(ptr, " -loglevel %s", loglevel());
+    // Input stream format
+    ptr += sprintf(ptr, " -f:v rawvideo -pixel_format %s", sVideoFormat(format));
+    
+    // Frame rate
+    ptr += sprintf(ptr, " -r %d", frameRate);
 
-        // Input stream format
-        ptr += sprintf(ptr, " -f:v rawvideo -pixel_format rgba");
-        
-        // Frame rate
-        ptr += sprintf(ptr, " -r %d", frameRate);
+    // Frame size (width x height)
+    ptr += sprintf(ptr, " -s:v %dx%d", cutout.x2 - cutout.x1, cutout.y2 - cutout.y1);
+    
+    // Input source (named pipe)
+    ptr += sprintf(ptr, " -i %s", videoPipePath());
 
-        // Frame size (width x height)
-        ptr += sprintf(ptr, " -s:v %dx%d", x2 - x1, y2 - y1);
-        
-        // Input source (named pipe)
-        ptr += sprintf(ptr, " -i %s", videoPipePath());
+    // Output stream format
+    ptr += sprintf(ptr, " -f mp4 -pix_fmt yuv420p");
 
-        // Output stream format
-        ptr += sprintf(ptr, " -f mp4 -pix_fmt yuv420p");
+    // Bit rate
+    ptr += sprintf(ptr, " -b:v %ldk", bitRate);
 
-        // Bit rate
-        ptr += sprintf(ptr, " -b:v %ldk", bitRate);
+    // Aspect ratio
+    ptr += sprintf(ptr, " -bsf:v ");
+    ptr += sprintf(ptr, "\"h264_metadata=sample_aspect_ratio=");
+    ptr += sprintf(ptr, "%ld/%ld\"", aspectX, 2*aspectY);
+    
+    // Output file
+    ptr += sprintf(ptr, " -y %s", videoStreamPath());
 
-        // Aspect ratio
-        ptr += sprintf(ptr, " -bsf:v ");
-        ptr += sprintf(ptr, "\"h264_metadata=sample_aspect_ratio=");
-        ptr += sprintf(ptr, "%ld/%ld\"", aspectX, 2*aspectY);
-        
-        // Output file
-        ptr += sprintf(ptr, " -y %s", videoStreamPath());
+    
+    //
+    // Assemble the command line arguments for the audio encoder
+    //
+    
+    char cmd2[512]; ptr = cmd2;
 
-        
-        //
-        // Assemble the command line arguments for the audio encoder
-        //
-        
-        char cmd2[512]; ptr = cmd2;
+    // Path to the FFmpeg executable
+    ptr += sprintf(ptr, "%s -nostdin", ffmpegPath());
+    
+    // Verbosity
+    ptr += sprintf(ptr, " -loglevel %s", loglevel());
 
-        // Path to the FFmpeg executable
-        ptr += sprintf(ptr, "%s -nostdin", ffmpegPath());
-        
-        // Verbosity
-        ptr += sprintf(ptr, " -loglevel %s", loglevel());
+    // Audio format and number of channels
+    ptr += sprintf(ptr, " -f:a f32le -ac 2");
 
-        // Audio format and number of channels
-        ptr += sprintf(ptr, " -f:a f32le -ac 2");
+    // Sampling rate
+    ptr += sprintf(ptr, " -sample_rate %d", sampleRate);
 
-        // Sampling rate
-        ptr += sprintf(ptr, " -sample_rate %d", sampleRate);
+    // Input source (named pipe)
+    ptr += sprintf(ptr, " -i %s", audioPipePath());
+    
+    // Output stream format
+    ptr += sprintf(ptr, " -f mp4");
 
-        // Input source (named pipe)
-        ptr += sprintf(ptr, " -i %s", audioPipePath());
+    // Output file
+    ptr += sprintf(ptr, " -y %s", audioStreamPath());
+    
+    //
+    // Launch FFmpeg instances
+    //
         
-        // Output stream format
-        ptr += sprintf(ptr, " -f mp4");
+    assert(videoFFmpeg == NULL);
+    assert(audioFFmpeg == NULL);
 
-        // Output file
-        ptr += sprintf(ptr, " -y %s", audioStreamPath());
-        
-        //
-        // Launch FFmpeg instances
-        //
-            
-        assert(videoFFmpeg == NULL);
-        assert(audioFFmpeg == NULL);
+    msg("\nStarting video encoder with options:\n%s\n", cmd1);
+    videoFFmpeg = popen(cmd1, "w");
+    msg(videoFFmpeg ? "Success\n" : "Failed to launch\n");
 
-        msg("\nStarting video encoder with options:\n%s\n", cmd1);
-        videoFFmpeg = popen(cmd1, "w");
-        msg(videoFFmpeg ? "Success\n" : "Failed to launch\n");
+    msg("\nStarting audio encoder with options:\n%s\n", cmd2);
+    audioFFmpeg = popen(cmd2, "w");
+    msg(audioFFmpeg ? "Success\n" : "Failed to launch\n");
+    
+    // Open pipes
+    videoPipe = open(videoPipePath(), O_WRONLY);
+    audioPipe = open(audioPipePath(), O_WRONLY);
 
-        msg("\nStarting audio encoder with options:\n%s\n", cmd2);
-        audioFFmpeg = popen(cmd2, "w");
-        msg(audioFFmpeg ? "Success\n" : "Failed to launch\n");
-        
-        // Open pipes
-        videoPipe = open(videoPipePath(), O_WRONLY);
-        audioPipe = open(audioPipePath(), O_WRONLY);
+    return videoFFmpeg && audioFFmpeg && videoPipe != -1 && audioPipe != -1;
+}
 
-        recording = videoFFmpeg && audioFFmpeg && videoPipe != -1 && audioPipe != -1;
+bool
+ScreenRecorder::openCaptureFiles(long aspectX, long aspectY)
+{
+    char path[512];
+    char header[128];
+
+    int width = cutout.x2 - cutout.x1;
+    int height = cutout.y2 - cutout.y1;
+
+    // Create the video file and write the stream header
+    snprintf(path, sizeof(path), "%s.y4m", capturePath);
+    msg("Capturing video to %s\n", path);
+    if (!videoFile.open(path, mappedOutput)) return false;
+
+    int len = snprintf(header, sizeof(header),
+                       "YUV4MPEG2 W%d H%d F%d:1 Ip A%ld:%ld C420jpeg XCOLORRANGE=LIMITED\n",
+                       width, height, frameRate, aspectX, 2 * aspectY);
+    if (!videoFile.write(header, len)) {
+        warn("Failed to write %s\n", path);
+        videoFile.close();
+        return false;
     }
 
-    if (isRecording()) {
-        messageQueue.put(MSG_RECORDING_STARTED);
-        return true;
+    // Create the audio file and write a preliminary RIFF header
+    snprintf(path, sizeof(path), "%s.wav", capturePath);
+    msg("Capturing audio to %s\n", path);
+    if (!audioFile.open(path, mappedOutput)) {
+        videoFile.close();
+        return false;
     }
-    
-    return false;
+    if (!audioFile.writeWavHeader(sampleRate, 0)) {
+        warn("Failed to write %s\n", path);
+        videoFile.close();
+        audioFile.close();
+        return false;
+    }
+
+    return true;
 }
 
 void
@@ -173,33 +365,62 @@ ScreenRecorder::stopRecording()
 {
     debug(REC_DEBUG, "stopRecording()\n");
     
-    if (!isRecording()) return;
-    
     synchronized {
+
+        // Check if the recorder has been stopped in the meantime
+        if (!recording) return;
+
         recording = false;
         recordCounter++;
     }
 
-    // Close pipes
-    close(videoPipe);
-    close(audioPipe);
-    videoPipe = -1;
-    audioPipe = -1;
-     
-    // Shut down encoders
-    pclose(videoFFmpeg);
-    pclose(audioFFmpeg);
-    videoFFmpeg = NULL;
-    audioFFmpeg = NULL;
+    // Let the writer thread flush all pending frames and terminate
+    {   std::lock_guard<std::mutex> lock(sleepMutex);
+        quit = true;
+    }
+    wakeUp.notify_one();
+    writer.join();
+    freeFrames();
+
+    if (sink == REC_SINK_RAW) {
+
+        // Finalize the WAV header and close the capture files
+        if (!audioFile.writeWavHeader(sampleRate, (u32)(audioFile.size() - 44))) {
+            warn("Failed to finalize the WAV header\n");
+            failed = true;
+        }
+        if (!videoFile.close()) failed = true;
+        if (!audioFile.close()) failed = true;
+
+    } else {
+
+        // Close pipes
+        close(videoPipe);
+        close(audioPipe);
+        videoPipe = -1;
+        audioPipe = -1;
+         
+        // Shut down encoders
+        pclose(videoFFmpeg);
+        pclose(audioFFmpeg);
+        videoFFmpeg = NULL;
+        audioFFmpeg = NULL;
+    }
 
     debug(REC_DEBUG, "Recording has stopped\n");
-    messageQueue.put(MSG_RECORDING_STOPPED);
+    messageQueue.put(failed ? MSG_RECORDING_ABORTED : MSG_RECORDING_STOPPED);
 }
 
 bool
 ScreenRecorder::exportAs(const char *path)
 {
     if (isRecording()) return false;
+
+    // The raw capture sink writes its output files directly
+    if (sink == REC_SINK_RAW) {
+        warn("Nothing to export. Raw captures are stored in %s\n", capturePath);
+        return false;
+    }
     
     //
     // Assemble the command line arguments for the video encoder
@@ -246,12 +467,40 @@ ScreenRecorder::vsyncHandler(Cycle target)
 {
     if (!isRecording()) return;
     
+    // Stop if the writer thread can't continue
+    if (failed || full) {
+        if (full) msg("Maximum capture size reached\n");
+        stopRecording();
+        return;
+    }
+
     // debug("vsyncHandler\n");
-    assert(videoFFmpeg != NULL);
-    assert(audioFFmpeg != NULL);
+    assert(sink == REC_SINK_RAW || videoFFmpeg != NULL);
+    assert(sink == REC_SINK_RAW || audioFFmpeg != NULL);
 
     synchronized {
         
+        // Check if the recorder has been stopped in the meantime
+        if (!recording) return;
+
+        int pos = w.load(std::memory_order_relaxed);
+        int next = (pos + 1) % queueSize;
+        
+        // Check if the writer thread has fallen behind
+        if (next == r.load(std::memory_order_acquire)) {
+
+            if (policy == REC_DROP_FRAMES) {
+
+                // Skip the frame to keep the video and audio stream in sync
+                if (audioClock) audioClock = target;
+                dropped++;
+                return;
+            }
+            while (next == r.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
         //
         // Video
         //
@@ -261,40 +510,236 @@ ScreenRecorder::vsyncHandler(Cycle target)
         int width = sizeof(u32) * (cutout.x2 - cutout.x1);
         int height = cutout.y2 - cutout.y1;
         int offset = cutout.y1 * HPIXELS + cutout.x1 + HBLANK_MIN * 4;
-        u8 *data = new u8[width * height];
         u8 *src = (u8 *)(buffer.data + offset);
-        u8 *dst = data;
+        u8 *dst = frames[pos].video;
         for (int y = 0; y < height; y++, src += 4 * HPIXELS, dst += width) {
             memcpy(dst, src, width);
         }
-
-        // Feed the video pipe
-        assert(videoPipe != -1);
-        write(videoPipe, data, (size_t)(width * height));
         
         //
         // Audio
         //
         
-        // Clone Paula's muxer contents
-        muxer.sampler[0] = paula.muxer.sampler[0];
-        muxer.sampler[1] = paula.muxer.sampler[1];
-        muxer.sampler[2] = paula.muxer.sampler[2];
-        muxer.sampler[3] = paula.muxer.sampler[3];
-        assert(muxer.sampler[0].r == paula.muxer.sampler[0].r);
-        assert(muxer.sampler[0].w == paula.muxer.sampler[0].w);
+        // Read Paula's sample history through a set of private cursors
+        if (audioClock == 0) {
+            muxer.attach(paula.muxer);
+            audioClock = target-1;
+        }
 
         // Synthesize audio samples for this frame
-        if (audioClock == 0) audioClock = target-1;
         muxer.synthesize(audioClock, target, samplesPerFrame);
         audioClock = target;
         
         // Copy samples to buffer
-        float *samples = new float[2 * samplesPerFrame];
-        muxer.copyInterleaved(samples, samplesPerFrame);
-                
-        // Feed the audio pipe
-        assert(audioPipe != -1);
-        write(audioPipe, (u8 *)samples, (size_t)(2 * sizeof(float) * samplesPerFrame));
+        muxer.copyInterleaved(frames[pos].audio, samplesPerFrame);
+
+        // Hand the frame over to the writer thread
+        w.store(next);
+        queued++;
+        
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeUp.notify_one();
+        }
+    }
+}
+
+void
+ScreenRecorder::allocateFrames(size_t videoSize, size_t audioSize)
+{
+    freeFrames();
+
+    for (int i = 0; i < queueSize; i++) {
+        frames[i].video = new u8[videoSize];
+        frames[i].audio = new float[audioSize];
+    }
+    if (streamFormat() != VIDEO_RGBA) {
+        yuvBuffer = new u8[videoSize * 3 / 8];
+    }
+    r = 0;
+    w = 0;
+}
+
+void
+ScreenRecorder::freeFrames()
+{
+    for (int i = 0; i < queueSize; i++) {
+        delete[] frames[i].video;
+        delete[] frames[i].audio;
+        frames[i].video = NULL;
+        frames[i].audio = NULL;
     }
+    delete[] yuvBuffer;
+    yuvBuffer = NULL;
+}
+
+void
+ScreenRecorder::main()
+{
+    debug(REC_DEBUG, "Writer thread started\n");
+
+    while (true) {
+
+        int pos = r.load(std::memory_order_relaxed);
+
+        // Go to sleep if there is nothing to do
+        if (pos == w.load(std::memory_order_acquire)) {
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping = true;
+            wakeUp.wait(lock, [&]{ return quit || pos != w.load(); });
+            sleeping = false;
+
+            // Terminate if all pending frames have been written
+            if (quit && pos == w.load()) break;
+            continue;
+        }
+
+        // Discard the frame if the recording can't be continued
+        if (!failed && !full) {
+
+            u8 *video = frames[pos].video;
+            size_t videoSize = frameSize;
+
+            u8 *audio = (u8 *)frames[pos].audio;
+            size_t audioSize = 2 * sizeof(float) * samplesPerFrame;
+
+            // Convert the pixel format if requested
+            if (streamFormat() != VIDEO_RGBA) {
+                convert(video, yuvBuffer);
+                video = yuvBuffer;
+                videoSize = frameSize * 3 / 8;
+            }
+
+            if (!writeFrame(video, videoSize, audio, audioSize)) failed = true;
+        }
+        if (failed || full) dropped++; else written++;
+
+        // Release the buffer
+        r.store((pos + 1) % queueSize, std::memory_order_release);
+    }
+
+    debug(REC_DEBUG, "Writer thread terminated\n");
+}
+
+/* Converts two rows of RGBA pixels to YUV 4:2:0 (ITU-R BT.601, limited range).
+ * This is the reference implementation for rgbaToYUVSSE().
+ */
+static void
+rgbaToYUV(u8 *row0, u8 *row1, u8 *y0, u8 *y1, u8 *u, u8 *v,
+          int width, bool interleaved)
+{
+    for (int i = 0; i < width; i += 2) {
+
+        int r = 0, g = 0, b = 0;
+        for (int j = 0; j < 2; j++) {
+
+            u8 *p0 = row0 + 4 * (i + j);
+            u8 *p1 = row1 + 4 * (i + j);
+            y0[i + j] = (u8)(((66 * p0[0] + 129 * p0[1] + 25 * p0[2] + 128) >> 8) + 16);
+            y1[i + j] = (u8)(((66 * p1[0] + 129 * p1[1] + 25 * p1[2] + 128) >> 8) + 16);
+            r += p0[0] + p1[0];
+            g += p0[1] + p1[1];
+            b += p0[2] + p1[2];
+        }
+        u8 cb = (u8)(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+        u8 cr = (u8)(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+
+        if (interleaved) {
+            u[i] = cb;
+            u[i + 1] = cr;
+        } else {
+            u[i / 2] = cb;
+            v[i / 2] = cr;
+        }
+    }
+}
+
+void
+ScreenRecorder::convert(u8 *src, u8 *dst)
+{
+    assert(streamFormat() == VIDEO_YUV420P || streamFormat() == VIDEO_NV12);
+
+    int width = cutout.x2 - cutout.x1;
+    int height = cutout.y2 - cutout.y1;
+
+    convert(src, dst, width, height, streamFormat() == VIDEO_NV12, !NO_SSE);
+}
+
+void
+ScreenRecorder::convert(u8 *src, u8 *dst, int width, int height, bool nv12, bool sse)
+{
+    // Setup the plane pointers
+    u8 *y = dst;
+    u8 *u = y + width * height;
+    u8 *v = u + (width / 2) * (height / 2);
+    int uvStride = nv12 ? width : width / 2;
+
+    for (int row = 0; row < height; row += 2) {
+
+        u8 *row0 = src + 4 * width * row;
+        u8 *row1 = row0 + 4 * width;
+        u8 *y0 = y + width * row;
+        u8 *y1 = y0 + width;
+        u8 *u0 = u + uvStride * (row / 2);
+        u8 *v0 = v + uvStride * (row / 2);
+
+        // On Intel machines, convert multiple pixels at once
+        #if defined(__i386__) || defined(__x86_64__)
+
+        if (sse) {
+            rgbaToYUVSSE(row0, row1, y0, y1, u0, v0, width, nv12);
+            continue;
+        }
+
+        #endif
+
+        rgbaToYUV(row0, row1, y0, y1, u0, v0, width, nv12);
+    }
+}
+
+bool
+ScreenRecorder::writeFrame(u8 *video, size_t videoSize, u8 *audio, size_t audioSize)
+{
+    if (sink == REC_SINK_RAW) {
+
+        // Stop before the WAV data chunk exceeds its 32-bit size field
+        if (audioFile.size() - 44 + audioSize > maxWavDataSize) {
+            full = true;
+            return true;
+        }
+
+        // Append the frame to the capture files
+        if (!videoFile.write("FRAME\n", 6) ||
+            !videoFile.write(video, videoSize) ||
+            !audioFile.write(audio, audioSize)) {
+
+            warn("Failed to write into capture file\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Feed the pipes
+    return
+    writeToPipe(videoPipe, video, videoSize) &&
+    writeToPipe(audioPipe, audio, audioSize);
+}
+
+bool
+ScreenRecorder::writeToPipe(int pipe, u8 *data, size_t size)
+{
+    assert(pipe != -1);
+
+    while (size) {
+
+        ssize_t count = write(pipe, data, size);
+        if (count <= 0) {
+            warn("Failed to write into pipe\n");
+            return false;
+        }
+        data += count;
+        size -= count;
+    }
+    return true;
 }
@@ -12,9 +12,14 @@
 
 #include "AmigaComponent.h"
 #include "Muxer.h"
+#include "CaptureFile.h"
+#include <atomic>
+#include <condition_variable>
 
 class ScreenRecorder : public AmigaComponent {
 
+    friend class ConverterBench;
+
     //
     // Constants
     //
@@ -35,9 +40,20 @@ class ScreenRecorder : public AmigaComponent {
     static const int sampleRate = 44100;
     static const int samplesPerFrame = sampleRate / frameRate;
 
+    /* Maximum size of the audio data in a raw capture. The WAV header stores
+     * the size of the data chunk and the size of the RIFF chunk, which is 36
+     * bytes larger, as 32-bit values. This limits a capture to about 3.38
+     * hours of 32-bit stereo audio at 44.1 kHz. The recording stops
+     * automatically when this limit is reached. The Y4M file has no limit.
+     */
+    static const size_t maxWavDataSize = 0xFFFFFFFF - 36;
+
     // Log level passed to FFmpef
     static const char *loglevel() { return REC_DEBUG ? "verbose" : "warning"; }
     
+    // Number of frames the emulator can run ahead of the encoder
+    static const int queueSize = 8;
+    
     
     //
     // Sub components
@@ -59,6 +75,68 @@ class ScreenRecorder : public AmigaComponent {
     int videoPipe = -1;
     int audioPipe = -1;
 
+    // Output files of the raw capture sink
+    CaptureFile videoFile;
+    CaptureFile audioFile;
+
+    
+    //
+    // Frame queue
+    //
+
+    /* Recorded frames are passed to a writer thread which feeds the pipes.
+     * The buffers are allocated when a recording starts and reused for all
+     * subsequent frames. The queue is a single-producer, single-consumer
+     * ring buffer with the emulator thread as producer.
+     */
+    struct { u8 *video; float *audio; } frames[queueSize];
+
+    // Read and write pointers
+    std::atomic<int> r;
+    std::atomic<int> w;
+
+    // The writer thread
+    std::thread writer;
+
+    // Synchronization primitives for putting the writer thread to sleep
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<bool> sleeping;
+
+    // Indicates if the writer thread is supposed to terminate
+    std::atomic<bool> quit;
+
+    /* Set by the writer thread if the recording can't be continued because
+     * an output stream failed (failed) or the WAV size limit has been reached
+     * (full). Subsequent frames are discarded and the emulator thread stops
+     * the recording in the next frame.
+     */
+    std::atomic<bool> failed;
+    std::atomic<bool> full;
+
+    // Indicates what happens if the frame queue is full
+    RecordingPolicy policy = REC_DROP_FRAMES;
+
+    // Pixel format of the video stream passed to FFmpeg
+    VideoFormat format = VIDEO_RGBA;
+
+    // Destination of the recorded streams
+    RecordingSink sink = REC_SINK_FFMPEG;
+
+    // Output path of the raw capture sink (without file name extension)
+    char *capturePath = NULL;
+
+    // Indicates if the raw capture files are written via memory mapping
+    bool mappedOutput = false;
+
+    // Target buffer for the pixel format conversion (used by the writer)
+    u8 *yuvBuffer = NULL;
+
+    // Statistics
+    std::atomic<long> queued;
+    std::atomic<long> dropped;
+    std::atomic<long> written;
+
     
     //
     // Recording status
@@ -83,6 +161,9 @@ class ScreenRecorder : public AmigaComponent {
 
     // Bitrate passed to FFmpeg
     long bitRate = 0;
+
+    // Size of a single RGBA frame in bytes
+    size_t frameSize = 0;
     
     // Pixel aspect ratio
     long aspectX;
@@ -96,6 +177,7 @@ class ScreenRecorder : public AmigaComponent {
 public:
     
     ScreenRecorder(Amiga& ref);
+    ~ScreenRecorder();
     
     bool hasFFmpeg();
     
@@ -110,6 +192,11 @@ private:
     
     void _dump() override;
     
+public:
+    
+    RecorderStats getStats();
+    void clearStats();
+
     
     //
     // Serializing
@@ -135,6 +222,7 @@ private:
     size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
     size_t _load(u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
     size_t _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    size_t didLoadFromBuffer(u8 *buffer) override;
 
     
     //
@@ -143,8 +231,24 @@ private:
     
 public:
     
-    // Sets the target file name
+    // Selects the destination of the recorded streams
+    RecordingSink getSink() { return sink; }
+    bool setSink(RecordingSink value);
+
+    // Sets the target file name of the raw capture sink (without extension)
     bool setPath(const char *path);
+
+    // Enables or disables memory-mapped output in the raw capture sink
+    bool getMappedOutput() { return mappedOutput; }
+    void setMappedOutput(bool value) { mappedOutput = value; }
+    
+    // Gets or sets the behaviour in case the encoder can't keep up
+    RecordingPolicy getPolicy() { return policy; }
+    void setPolicy(RecordingPolicy value);
+
+    // Gets or sets the pixel format of the video stream
+    VideoFormat getFormat() { return format; }
+    bool setFormat(VideoFormat value);
     
     
     //
@@ -168,6 +272,16 @@ public:
     // Stops the screen recorder
     void stopRecording();
 
+private:
+
+    // Launches two FFmpeg instances and connects them via named pipes
+    bool launchFFmpeg(long bitRate, long aspectX, long aspectY);
+
+    // Creates the output files of the raw capture sink
+    bool openCaptureFiles(long aspectX, long aspectY);
+
+public:
+
     // Exports the recorded video
     bool exportAs(const char *path);
     
@@ -183,6 +297,28 @@ public:
     
     // Records a single frame
     void vsyncHandler(Cycle target);
+
+private:
+
+    // Allocates or frees the frame buffers
+    void allocateFrames(size_t videoSize, size_t audioSize);
+    void freeFrames();
+
+    // Main loop of the writer thread
+    void main();
+
+    // Returns the pixel format of the outgoing video stream
+    VideoFormat streamFormat() { return sink == REC_SINK_RAW ? VIDEO_YUV420P : format; }
+
+    // Converts a recorded RGBA frame to the selected YUV format
+    void convert(u8 *src, u8 *dst);
+    static void convert(u8 *src, u8 *dst, int width, int height, bool nv12, bool sse);
+
+    // Writes a recorded frame to the selected sink
+    bool writeFrame(u8 *video, size_t videoSize, u8 *audio, size_t audioSize);
+
+    // Writes a chunk of data into a pipe
+    bool writeToPipe(int pipe, u8 *data, size_t size);
 };
 
 #endif
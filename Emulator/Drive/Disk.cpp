@@ -8,19 +8,27 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "SSEUtils.h"
 
 Disk::Disk(DiskType type) : geometry(type)
 {
     setDescription("Disk");
     
-    data = new u8[geometry.diskSize];
+    assert(geometry.tracks <= maxTracks);
+    
+    for (Track t = 0; t < maxTracks; t++) {
+        data[t] = nullptr;
+        dirty[t] = false;
+        unsaved[t] = false;
+    }
     this->type = type;
     clearDisk();
 }
 
 Disk::~Disk()
 {
-    delete [] data;
+    releaseTracks();
+    delete [] image;
 }
 
 Disk *
@@ -43,11 +51,62 @@ Disk::makeWithReader(SerReader &reader, DiskType diskType)
 {
     Disk *disk = new Disk(diskType);
     disk->applyToPersistentItems(reader);
-    reader.copy(disk->data, disk->geometry.diskSize);
+    
+    // Read the source image
+    reader & disk->imageTracks & disk->imageSectors;
+    if (long size = disk->imageTracks * disk->imageSectors * 512) {
+        
+        disk->image = new u8[size];
+        reader.copy(disk->image, size);
+    }
+    
+    // Read all tracks that have been written to
+    for (Track t = 0; t < disk->geometry.tracks; t++) {
+        
+        bool stored;
+        reader & stored;
+        if (!stored) continue;
+        
+        disk->data[t] = new u8[disk->geometry.trackSize];
+        disk->dirty[t] = true;
+        reader.copy(disk->data[t], disk->geometry.trackSize);
+    }
     
     return disk;
 }
 
+size_t
+Disk::sizeOfTracks()
+{
+    SerCounter counter;
+    
+    counter & imageTracks & imageSectors;
+    counter.count += imageTracks * imageSectors * 512;
+    
+    for (Track t = 0; t < geometry.tracks; t++) {
+        
+        bool stored = data[t] && dirty[t];
+        counter & stored;
+        if (stored) counter.count += geometry.trackSize;
+    }
+    return counter.count;
+}
+
+void
+Disk::saveTracks(SerWriter &writer)
+{
+    writer & imageTracks & imageSectors;
+    if (imageTracks) writer.copy(image, imageTracks * imageSectors * 512);
+    
+    // Clean tracks can be recreated from the source image
+    for (Track t = 0; t < geometry.tracks; t++) {
+        
+        bool stored = data[t] && dirty[t];
+        writer & stored;
+        if (stored) writer.copy(data[t], geometry.trackSize);
+    }
+}
+
 void
 Disk::dump()
 {
@@ -62,6 +121,23 @@ Disk::dump()
     msg("         trackSize: %ld\n", geometry.trackSize);
     msg("      cylinderSize: %ld\n", geometry.cylinderSize);
     msg("          diskSize: %ld\n", geometry.diskSize);
+    msg("     encodedTracks: %ld\n", numEncodedTracks());
+}
+
+long
+Disk::numEncodedTracks()
+{
+    long result = 0;
+    for (Track t = 0; t < geometry.tracks; t++) if (data[t]) result++;
+    return result;
+}
+
+long
+Disk::numUnsavedTracks()
+{
+    long result = 0;
+    for (Track t = 0; t < geometry.tracks; t++) if (unsaved[t]) result++;
+    return result;
 }
 
 u8
@@ -70,7 +146,7 @@ Disk::readByte(Track track, u16 offset)
     assert(track < geometry.tracks);
     assert(offset < geometry.trackSize);
 
-    return data[track * geometry.trackSize + offset];
+    return ptr(track)[offset];
 }
 
 u8
@@ -80,11 +156,7 @@ Disk::readByte(Cylinder cylinder, Side side, u16 offset)
     assert(side < geometry.sides);
     assert(offset < geometry.trackSize);
 
-    return data[(2 * cylinder + side) * geometry.trackSize + offset];
-    /*
-    assert(data.raw[(2 * cylinder + side) * geometry.trackSize + offset] == data.cyclinder[cylinder][side][offset]);
-    return data.cyclinder[cylinder][side][offset];
-    */
+    return ptr(2 * cylinder + side)[offset];
 }
 
 void
@@ -93,7 +165,10 @@ Disk::writeByte(u8 value, Track track, u16 offset)
     assert(track < geometry.tracks);
     assert(offset < geometry.trackSize);
 
-    data[track * geometry.trackSize + offset] = value;
+    ptr(track)[offset] = value;
+    dirty[track] = true;
+    unsaved[track] = true;
+    invalidateSyncIndex(track);
 }
 
 void
@@ -103,14 +178,16 @@ Disk::writeByte(u8 value, Cylinder cylinder, Side side, u16 offset)
     assert(side < geometry.sides);
     assert(offset < geometry.trackSize);
 
-    // data.cyclinder[cylinder][side][offset] = value;
-    data[(2 * cylinder + side) * geometry.trackSize + offset] = value;
+    writeByte(value, 2 * cylinder + side, offset);
 }
 
 u8 *
 Disk::ptr(Track track)
 {
-    return data + geometry.trackSize * track;
+    assert(track < geometry.tracks);
+    
+    if (!data[track]) encodeTrack(track);
+    return data[track];
 }
 
 u8 *
@@ -120,25 +197,83 @@ Disk::ptr(Track track, Sector sector)
 }
 
 void
-Disk::clearDisk()
+Disk::readSector(u8 *dst, Track t, Sector s)
 {
-    fnv = 0;
+    assert(image != NULL);
+    assert(t < imageTracks);
+    assert(s < imageSectors);
+    
+    memcpy(dst, image + (t * imageSectors + s) * 512, 512);
+}
 
-    // Initialize with random data
-    srand(0);
-    for (int i = 0; i < geometry.diskSize; i++) {
-        data[i] = rand() & 0xFF;
+long
+Disk::nextSyncMark(Track t, u16 sync, long offset)
+{
+    assert(t < geometry.tracks);
+    
+    const vector<u16> &marks = syncMarks(t, sync);
+    auto it = std::lower_bound(marks.begin(), marks.end(), offset);
+    
+    return it == marks.end() ? -1 : *it;
+}
+
+const vector<u16> &
+Disk::syncMarks(Track t, u16 sync)
+{
+    SyncIndex *index = syncIndex[t];
+    u8 *p = ptr(t);
+    
+    // Check if the index is cached
+    if (index[0].valid && index[0].sync == sync) return index[0].positions;
+    if (index[1].valid && index[1].sync == sync) return index[1].positions;
+
+    // Replace the older entry
+    std::swap(index[0], index[1]);
+    index[0].valid = true;
+    index[0].sync = sync;
+    index[0].positions.clear();
+    
+    // Collect the positions of all sync marks in this track
+    u8 hi = HI_BYTE(sync), lo = LO_BYTE(sync);
+    u8 prev = p[geometry.trackSize - 1];
+    
+    for (long i = 0; i < geometry.trackSize; prev = p[i++]) {
+        if (p[i] == lo && prev == hi) index[0].positions.push_back((u16)i);
     }
     
-    /* In order to make some copy protected game titles work, we smuggle in
-     * some magic values. E.g., Crunch factory expects 0x44A2 on cylinder 80.
-     */
-    if (type == DISK_35_DD) {
+    return index[0].positions;
+}
+
+void
+Disk::invalidateSyncIndex(Track t)
+{
+    syncIndex[t][0].valid = false;
+    syncIndex[t][1].valid = false;
+}
+
+void
+Disk::clearDisk()
+{
+    fnv = 0;
+
+    // Get rid of the source image and all encoded tracks
+    delete [] image;
+    image = nullptr;
+    imageTracks = 0;
+    imageSectors = 0;
+    releaseTracks();
+}
+
+void
+Disk::releaseTracks()
+{
+    for (Track t = 0; t < maxTracks; t++) {
         
-        for (int t = 0; t < geometry.tracks; t++) {
-            writeByte(0x44, t, 0);
-            writeByte(0xA2, t, 1);
-        }
+        delete [] data[t];
+        data[t] = nullptr;
+        dirty[t] = false;
+        unsaved[t] = false;
+        invalidateSyncIndex(t);
     }
 }
 
@@ -147,11 +282,10 @@ Disk::clearTrack(Track t)
 {
     assert(t < geometry.tracks);
 
-    srand(0);
-    for (int i = 0; i < geometry.trackSize; i++) {
-        writeByte(rand() & 0xFF, t, i);
-        // data.track[t][i] = rand() & 0xFF;
-    }
+    fillWithNoise(ptr(t), geometry.trackSize, 0);
+    dirty[t] = true;
+    unsaved[t] = true;
+    invalidateSyncIndex(t);
 }
 
 void
@@ -159,9 +293,10 @@ Disk::clearTrack(Track t, u8 value)
 {
     assert(t < geometry.tracks);
 
-    for (int i = 0; i < geometry.trackSize; i++) {
-        writeByte(value, t, i);
-    }
+    memset(ptr(t), value, geometry.trackSize);
+    dirty[t] = true;
+    unsaved[t] = true;
+    invalidateSyncIndex(t);
 }
 
 void
@@ -170,10 +305,15 @@ Disk::clearTrack(Track t, u8 value1, u8 value2)
     assert(t < geometry.tracks);
     assert(geometry.trackSize % 2 == 0);
 
+    u8 *p = ptr(t);
+    
     for (int i = 0; i < geometry.trackSize; i += 2) {
-        writeByte(value1, t, i);
-        writeByte(value2, t, i + 1);
+        p[i] = value1;
+        p[i + 1] = value2;
     }
+    dirty[t] = true;
+    unsaved[t] = true;
+    invalidateSyncIndex(t);
 }
 
 bool
@@ -185,38 +325,107 @@ Disk::encodeDisk(DiskFile *df)
     // Start with an unformatted disk
     clearDisk();
 
-    // Call the proper encoder for this disk
-    return isAmigaDiskType(getType()) ? encodeAmigaDisk(df) : encodeDosDisk(df);
+    // Take over the sector data
+    imageTracks = MIN(df->numTracks(), geometry.tracks);
+    imageSectors = df->numSectorsPerTrack();
+    image = new u8[imageTracks * imageSectors * 512];
+    for (Track t = 0; t < imageTracks; t++) {
+        for (Sector s = 0; s < imageSectors; s++) {
+            df->readSector(image + (t * imageSectors + s) * 512, t, s);
+        }
+    }
+    
+    debug(MFM_DEBUG, "Disk prepared for encoding (%d tracks, %d sectors)\n",
+          imageTracks, imageSectors);
+
+    // In debug mode, run the encoder and the decoder
+    if (MFM_DEBUG) {
+        
+        encodeAllTracks();
+        for (Track t = 0; t < imageTracks; t++) dirty[t] = true;
+
+        if (isAmigaDiskType(getType())) {
+            ADFFile *tmp = ADFFile::makeWithDisk(this);
+            if (tmp) {
+                msg("Decoded image written to /tmp/debug.adf\n");
+                tmp->writeToFile("/tmp/tmp.adf");
+            }
+        } else {
+            IMGFile *tmp = IMGFile::makeWithDisk(this);
+            if (tmp) {
+                msg("Decoded image written to /tmp/debug.img\n");
+                tmp->writeToFile("/tmp/tmp.img");
+            }
+        }
+    }
+
+    return true;
 }
 
-bool
-Disk::encodeAmigaDisk(DiskFile *df)
+void
+Disk::fillWithNoise(u8 *dst, size_t count, u64 offset)
 {
-    bool result = true;
-    long tracks = df->numTracks();
+    const u64 a = 16807, m = 0x7FFFFFFF;
     
-    debug(MFM_DEBUG, "Encoding Amiga disk with %d tracks\n", tracks);
+    // Jump ahead in the stream (x = x0 * a^offset mod m)
+    u64 x = 123459876;
+    for (u64 f = a, n = offset; n; n >>= 1, f = f * f % m) {
+        if (n & 1) x = x * f % m;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        x = x * a % m;
+        dst[i] = (u8)x;
+    }
+}
 
-    // Encode all tracks
-    for (Track t = 0; t < tracks; t++) result &= encodeAmigaTrack(df, t);
+void
+Disk::encodeAllTracks()
+{
+    for (Track t = 0; t < geometry.tracks; t++) ptr(t);
+}
 
-    // In debug mode, also run the decoder
-    if (MFM_DEBUG) {
-        debug("Amiga disk fully encoded (success = %d)\n", result);
-        ADFFile *tmp = ADFFile::makeWithDisk(this);
-        if (tmp) {
-            msg("Decoded image written to /tmp/debug.adf\n");
-            tmp->writeToFile("/tmp/tmp.adf");
+void
+Disk::encodeTrack(Track t)
+{
+    assert(t < geometry.tracks);
+    assert(data[t] == nullptr);
+    
+    data[t] = new u8[geometry.trackSize];
+    invalidateSyncIndex(t);
+    
+    if (t < imageTracks) {
+        
+        // Call the proper encoder for this disk
+        if (isAmigaDiskType(getType())) {
+            encodeAmigaTrack(t);
+        } else {
+            encodeDosTrack(t);
+        }
+        
+    } else {
+        
+        // Initialize unformatted tracks with random data
+        fillWithNoise(data[t], geometry.trackSize, t * geometry.trackSize);
+        
+        /* In order to make some copy protected game titles work, we smuggle
+         * in some magic values. E.g., Crunch factory expects 0x44A2 on
+         * cylinder 80.
+         */
+        if (type == DISK_35_DD) {
+            data[t][0] = 0x44;
+            data[t][1] = 0xA2;
         }
     }
-
-    return result;
+    
+    dirty[t] = false;
+    unsaved[t] = false;
 }
 
 bool
-Disk::encodeAmigaTrack(DiskFile *df, Track t)
+Disk::encodeAmigaTrack(Track t)
 {
-    long sectors = df->numSectorsPerTrack();
+    long sectors = imageSectors;
     
     trace(MFM_DEBUG, "Encoding Amiga track %d (%d sectors)\n", t, sectors);
 
@@ -225,13 +434,12 @@ Disk::encodeAmigaTrack(DiskFile *df, Track t)
 
     // Encode all sectors
     bool result = true;
-    for (Sector s = 0; s < sectors; s++) result &= encodeAmigaSector(df, t, s);
+    for (Sector s = 0; s < sectors; s++) result &= encodeAmigaSector(t, s);
     
     // Rectify the first clock bit (where buffer wraps over)
     u8 *strt = ptr(t);
     u8 *stop = ptr(t) + geometry.trackSize - 1;
     if (*stop & 0x01) *strt &= 0x7F;
-    // if (data.track[t][trackSize - 1] & 1) data.track[t][0] &= 0x7F;
 
     // Compute a debug checksum
     if (MFM_DEBUG) {
@@ -243,7 +451,7 @@ Disk::encodeAmigaTrack(DiskFile *df, Track t)
 }
 
 bool
-Disk::encodeAmigaSector(DiskFile *df, Track t, Sector s)
+Disk::encodeAmigaSector(Track t, Sector s)
 {
     assert(t < geometry.tracks);
     assert(s < geometry.sectors);
@@ -261,7 +469,6 @@ Disk::encodeAmigaSector(DiskFile *df, Track t, Sector s)
      */
     
     u8 *p = ptr(t, s);
-    // u8 *p = data.track[t] + (s * sectorSize) + trackGapSize;
     
     // Bytes before SYNC
     p[0] = (p[-1] & 1) ? 0x2A : 0xAA;
@@ -286,7 +493,7 @@ Disk::encodeAmigaSector(DiskFile *df, Track t, Sector s)
     
     // Data
     u8 bytes[512];
-    df->readSector(bytes, t, s);
+    readSector(bytes, t, s);
     encodeOddEven(&p[64], bytes, sizeof(bytes));
     
     // Block checksum
@@ -310,50 +517,22 @@ Disk::encodeAmigaSector(DiskFile *df, Track t, Sector s)
     encodeOddEven(&p[56], dcheck, sizeof(bcheck));
     
     // Add clock bits
-    for(unsigned i = 8; i < 1088; i++) {
-        p[i] = addClockBits(p[i], p[i-1]);
-    }
+    addClockBits(&p[8], 1080);
     
     return true;
 }
 
 bool
-Disk::encodeDosDisk(DiskFile *df)
-{
-    bool result = true;
-    long tracks = df->numTracks();
-    
-    debug(MFM_DEBUG, "Encoding DOS disk with %d tracks\n", tracks);
-    
-    // Encode all tracks
-    for (Track t = 0; t < tracks; t++) result &= encodeDosTrack(df, t);
-    
-    // In debug mode, also run the decoder
-    if (MFM_DEBUG) {
-        debug("DOS disk fully encoded (success = %d)\n", result);
-        IMGFile *tmp = IMGFile::makeWithDisk(this);
-        if (tmp) {
-            msg("Decoded image written to /tmp/debug.img\n");
-            tmp->writeToFile("/tmp/tmp.img");
-        }
-    }
-
-    return result;
-}
-
-bool
-Disk::encodeDosTrack(DiskFile *df, Track t)
+Disk::encodeDosTrack(Track t)
 {
-    long sectors = df->numSectorsPerTrack();
+    long sectors = imageSectors;
 
     debug(MFM_DEBUG, "Encoding DOS track %d with %d sectors\n", t, sectors);
 
     u8 *p = ptr(t);
-    // u8 *p = data.track[t];
 
     // Clear track
     clearTrack(t, 0x92, 0x54);
-    // for (int i = 0; i < trackSize; i += 2) { p[i] = 0x92; p[i+1] = 0x54; }
 
     // Encode track header
     p += 82;                                        // GAP
@@ -368,7 +547,7 @@ Disk::encodeDosTrack(DiskFile *df, Track t)
         
     // Encode all sectors
     bool result = true;
-    for (Sector s = 0; s < sectors; s++) result &= encodeDosSector(df, t, s);
+    for (Sector s = 0; s < sectors; s++) result &= encodeDosSector(t, s);
     
     // Compute a checksum for debugging
     if (MFM_DEBUG) {
@@ -380,7 +559,7 @@ Disk::encodeDosTrack(DiskFile *df, Track t)
 }
 
 bool
-Disk::encodeDosSector(DiskFile *df, Track t, Sector s)
+Disk::encodeDosSector(Track t, Sector s)
 {
     u8 buf[60 + 512 + 2 + 109]; // Header + Data + CRC + Gap
         
@@ -419,7 +598,7 @@ Disk::encodeDosSector(DiskFile *df, Track t, Sector s)
     buf[59] = 0xFB;
 
     // Write DATA
-    df->readSector(&buf[60], t, s);
+    readSector(&buf[60], t, s);
     
     // Compute and write CRC
     crc = crc16(&buf[56], 516);
@@ -431,7 +610,6 @@ Disk::encodeDosSector(DiskFile *df, Track t, Sector s)
 
     // Determine the start of this sector inside the current track
     u8 *p = ptr(t, s);
-    // u8 *p = data.track[t] + 194 + s * 1300;
 
     // Create the MFM data stream
     encodeMFM(p, buf, sizeof(buf));
@@ -450,6 +628,12 @@ Disk::encodeDosSector(DiskFile *df, Track t, Sector s)
     return true;
 }
 
+bool
+Disk::isCleanTrack(Track t, long numSectors)
+{
+    return image && t < imageTracks && numSectors == imageSectors && !dirty[t];
+}
+
 bool
 Disk::decodeAmigaDisk(u8 *dst, long numTracks, long numSectors)
 {
@@ -467,6 +651,12 @@ bool
 Disk::decodeAmigaTrack(u8 *dst, Track t, long numSectors)
 {
     assert(t < geometry.tracks);
+
+    // Clean tracks are taken from the source image
+    if (isCleanTrack(t, numSectors)) {
+        memcpy(dst, image + t * imageSectors * 512, numSectors * 512);
+        return true;
+    }
         
     trace(MFM_DEBUG, "Decoding track %d\n", t);
     
@@ -546,6 +736,12 @@ bool
 Disk::decodeDOSTrack(u8 *dst, Track t, long numSectors)
 {
     assert(t < geometry.tracks);
+
+    // Clean tracks are taken from the source image
+    if (isCleanTrack(t, numSectors)) {
+        memcpy(dst, image + t * imageSectors * 512, numSectors * 512);
+        return true;
+    }
         
     trace(MFM_DEBUG, "Decoding DOS track %d\n", t);
     
@@ -618,9 +814,92 @@ Disk::decodeDOSSector(u8 *dst, u8 *src)
     decodeMFM(dst, src, 512);
 }
 
+/* Lookup tables used by the MFM_LUT codec. The tables are computed once from
+ * the scalar reference implementation.
+ */
+struct MFMTables {
+    
+    // Maps a byte to its MFM word (without clock bits)
+    u16 encode[256];
+    
+    // Maps a MFM word to the encoded byte (clock bits are ignored)
+    u8 decode[65536];
+    
+    // Maps the previous byte's LSB and a byte to the byte with clock bits
+    u8 clock[512];
+    
+    MFMTables()
+    {
+        for (unsigned i = 0; i < 256; i++) {
+            
+            u16 mfm = 0;
+            for (unsigned b = 0; b < 8; b++) mfm |= ((i >> b) & 1) << (2 * b);
+            encode[i] = mfm;
+        }
+        for (unsigned i = 0; i < 65536; i++) {
+            
+            u8 byte = 0;
+            for (unsigned b = 0; b < 8; b++) byte |= ((i >> (2 * b)) & 1) << b;
+            decode[i] = byte;
+        }
+        for (unsigned i = 0; i < 512; i++) {
+            
+            u8 value = i & 0x55, prev = (u8)(i >> 8);
+            u8 cBitsInv = (u8)(value << 1) | (u8)(value >> 1) | (u8)(prev << 7);
+            clock[i] = value | (cBitsInv ^ 0xAA);
+        }
+    }
+    
+    static const MFMTables &get() { static MFMTables tables; return tables; }
+};
+
+MFMCodec
+Disk::preferredCodec()
+{
+    /* Note: pdep and pext are microcoded on AMD CPUs prior to Zen 3 and run
+     * slower than the lookup tables there. Use vAmigaBench to compare.
+     */
+    return (!NO_SSE && hasBMI2()) ? MFM_BMI2 : MFM_LUT;
+}
+
+void
+Disk::setCodec(MFMCodec value)
+{
+    assert(isMFMCodec(value));
+    
+    if (value == MFM_BMI2 && (NO_SSE || !hasBMI2())) {
+        warn("BMI2 is not supported by the host CPU\n");
+        return;
+    }
+    codec = value;
+}
+
 void
 Disk::encodeMFM(u8 *dst, u8 *src, size_t count)
 {
+    switch (codec) {
+            
+        case MFM_BMI2:
+            
+            encodeMFMBMI2(dst, src, count);
+            return;
+            
+        case MFM_LUT:
+        {
+            const u16 *table = MFMTables::get().encode;
+            
+            for (size_t i = 0; i < count; i++) {
+                
+                u16 mfm = table[src[i]];
+                dst[2*i+0] = HI_BYTE(mfm);
+                dst[2*i+1] = LO_BYTE(mfm);
+            }
+            return;
+        }
+        default:
+            break;
+    }
+    
     for(size_t i = 0; i < count; i++) {
         
         u16 mfm =
@@ -641,6 +920,26 @@ Disk::encodeMFM(u8 *dst, u8 *src, size_t count)
 void
 Disk::decodeMFM(u8 *dst, u8 *src, size_t count)
 {
+    switch (codec) {
+            
+        case MFM_BMI2:
+            
+            decodeMFMBMI2(dst, src, count);
+            return;
+            
+        case MFM_LUT:
+        {
+            const u8 *table = MFMTables::get().decode;
+            
+            for (size_t i = 0; i < count; i++) {
+                dst[i] = table[HI_LO(src[2*i], src[2*i+1])];
+            }
+            return;
+        }
+        default:
+            break;
+    }
+    
     for(size_t i = 0; i < count; i++) {
         
         u16 mfm = HI_LO(src[2*i], src[2*i+1]);
@@ -659,6 +958,29 @@ Disk::decodeMFM(u8 *dst, u8 *src, size_t count)
 void
 Disk::encodeOddEven(u8 *dst, u8 *src, size_t count)
 {
+    if (codec != MFM_SCALAR) {
+        
+        const u64 mask = 0x5555555555555555;
+        size_t i = 0;
+        
+        // Split eight bytes at once (the bit order doesn't matter here)
+        for (; i + 8 <= count; i += 8) {
+            
+            u64 data, odd, even;
+            memcpy(&data, src + i, 8);
+            odd = (data >> 1) & mask;
+            even = data & mask;
+            memcpy(dst + i, &odd, 8);
+            memcpy(dst + i + count, &even, 8);
+        }
+        for (; i < count; i++) {
+            
+            dst[i] = (src[i] >> 1) & 0x55;
+            dst[i + count] = src[i] & 0x55;
+        }
+        return;
+    }
+    
     // Encode odd bits
     for(size_t i = 0; i < count; i++)
         dst[i] = (src[i] >> 1) & 0x55;
@@ -671,6 +993,26 @@ Disk::encodeOddEven(u8 *dst, u8 *src, size_t count)
 void
 Disk::decodeOddEven(u8 *dst, u8 *src, size_t count)
 {
+    if (codec != MFM_SCALAR) {
+        
+        const u64 mask = 0x5555555555555555;
+        size_t i = 0;
+        
+        // Merge eight bytes at once (the bit order doesn't matter here)
+        for (; i + 8 <= count; i += 8) {
+            
+            u64 odd, even, data;
+            memcpy(&odd, src + i, 8);
+            memcpy(&even, src + i + count, 8);
+            data = ((odd & mask) << 1) | (even & mask);
+            memcpy(dst + i, &data, 8);
+        }
+        for (; i < count; i++) {
+            dst[i] = ((src[i] & 0x55) << 1) | (src[i + count] & 0x55);
+        }
+        return;
+    }
+    
     // Decode odd bits
     for(size_t i = 0; i < count; i++)
         dst[i] = (src[i] & 0x55) << 1;
@@ -683,6 +1025,49 @@ Disk::decodeOddEven(u8 *dst, u8 *src, size_t count)
 void
 Disk::addClockBits(u8 *dst, size_t count)
 {
+    switch (codec) {
+            
+        case MFM_BMI2:
+        {
+            /* Process eight bytes at once. The computation only depends on the
+             * data bits of the preceding byte which are never modified. Hence,
+             * there is no dependency between consecutive words.
+             */
+            const u64 data = 0x5555555555555555;
+            const u64 clock = 0xAAAAAAAAAAAAAAAA;
+            size_t i = 0;
+            
+            for (; i + 8 <= count; i += 8) {
+                
+                u64 value;
+                memcpy(&value, dst + i, 8);
+                value = __builtin_bswap64(value) & data;
+                
+                u64 lShifted = value << 1;
+                u64 rShifted = (value >> 1) | ((u64)dst[i - 1] << 63);
+                value |= ~(lShifted | rShifted) & clock;
+                
+                value = __builtin_bswap64(value);
+                memcpy(dst + i, &value, 8);
+            }
+            for (; i < count; i++) {
+                dst[i] = addClockBits(dst[i], dst[i-1]);
+            }
+            return;
+        }
+        case MFM_LUT:
+        {
+            const u8 *table = MFMTables::get().clock;
+            
+            for (size_t i = 0; i < count; i++) {
+                dst[i] = table[(dst[i-1] & 1) << 8 | dst[i]];
+            }
+            return;
+        }
+        default:
+            break;
+    }
+    
     for (size_t i = 0; i < count; i++) {
         dst[i] = addClockBits(dst[i], dst[i-1]);
     }
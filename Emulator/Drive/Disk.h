@@ -16,6 +16,11 @@
 class Disk : public AmigaObject {
     
     friend class Drive;
+    friend class DiskWriter;
+    friend class MFMBench;
+    
+    // Maximum number of tracks (84 cylinders, 2 sides)
+    static const long maxTracks = 168;
     
     // The type of this disk
     DiskType type;
@@ -23,8 +28,38 @@ class Disk : public AmigaObject {
     // The geometry of this disk (derived from the disk type in the constructor)
     DiskGeometry geometry;
     
-    // The MFM encoded disk data
-    u8 *data = nullptr;
+    /* The MFM encoded disk data. Tracks are encoded lazily when they are
+     * accessed for the first time. A NULL pointer indicates a track that
+     * hasn't been encoded yet.
+     */
+    u8 *data[maxTracks];
+    
+    /* Indicates if a track has been written to since it was encoded. Clean
+     * tracks are exported by copying sectors from the source image.
+     */
+    bool dirty[maxTracks];
+    
+    /* Indicates if a track has been written to since it was last handed over
+     * to the disk writer (see class DiskWriter).
+     */
+    bool unsaved[maxTracks];
+    
+    /* Cached positions of sync marks. For each track, the positions of up to
+     * two different sync words are stored in ascending order. An index is
+     * built on demand and discarded when the track is encoded or written.
+     */
+    struct SyncIndex {
+        
+        bool valid = false;
+        u16 sync = 0;
+        vector<u16> positions;
+    };
+    SyncIndex syncIndex[maxTracks][2];
+    
+    // The sector data this disk was created from (NULL if there is none)
+    u8 *image = nullptr;
+    long imageTracks = 0;
+    long imageSectors = 0;
     
     // Indicates if this disk is write protected
     bool writeProtected = false;
@@ -35,6 +70,9 @@ class Disk : public AmigaObject {
     // Checksum of this disk if it was created from an ADF file, 0 otherwise
     u64 fnv = 0;
     
+    // The MFM codec used for encoding and decoding (not serialized)
+    MFMCodec codec = preferredCodec();
+    
     
     //
     // Initializing
@@ -68,6 +106,13 @@ private:
         & fnv;
     }
 
+    /* Serializes the disk data. The source image is stored together with
+     * all tracks that have been written to. All other tracks are derived
+     * from the source image and encoded lazily after the snapshot is loaded.
+     */
+    size_t sizeOfTracks();
+    void saveTracks(SerWriter &writer);
+
 
     //
     // Accessing
@@ -76,6 +121,9 @@ private:
 public:
 
     DiskType getType() { return type; }
+    long getTrackSize() { return geometry.trackSize; }
+    long getNumSectors() { return geometry.sectors; }
+    long getSectorSize() { return geometry.sectorSize; }
     
     bool isWriteProtected() { return writeProtected; }
     void setWriteProtection(bool value) { writeProtected = value; }
@@ -85,6 +133,18 @@ public:
     
     u64 getFnv() { return fnv; }
     
+    MFMCodec getCodec() { return codec; }
+    void setCodec(MFMCodec value);
+
+    // Returns the fastest MFM codec supported by the host CPU
+    static MFMCodec preferredCodec();
+    
+    // Returns the number of tracks that have been encoded so far
+    long numEncodedTracks();
+    
+    // Returns the number of tracks that haven't been written back yet
+    long numUnsavedTracks();
+    
 
     //
     // Reading and writing
@@ -100,10 +160,35 @@ public:
 
 private:
     
-    // Returns a pointer into the raw data array
+    // Returns a pointer into the raw data array (encodes the track if needed)
     u8 *ptr(Track track);
     u8 *ptr(Track track, Sector sector);
     
+    // Reads a sector from the source image
+    void readSector(u8 *dst, Track t, Sector s);
+    
+    
+    //
+    // Locating sync marks
+    //
+    
+public:
+    
+    /* Returns the position of the first sync mark at or after the specified
+     * offset or -1 if there is none. A sync mark is located at position p if
+     * the bytes at p - 1 and p form the sync word. For p = 0, the last byte
+     * of the track is taken as predecessor.
+     */
+    long nextSyncMark(Track t, u16 sync, long offset);
+    
+private:
+    
+    // Returns the sync mark index for a certain track and sync word
+    const vector<u16> &syncMarks(Track t, u16 sync);
+    
+    // Discards the sync mark index of a track
+    void invalidateSyncIndex(Track t);
+    
     
     //
     // Erasing disks
@@ -119,27 +204,48 @@ public:
     void clearTrack(Track t, u8 value);
     void clearTrack(Track t, u8 value1, u8 value2);
 
+private:
+    
+    // Releases the MFM data of all tracks
+    void releaseTracks();
     
+    /* Fills a buffer with the random data of an unformatted disk. The bytes
+     * are taken from the stream of the minimal standard generator by Park
+     * and Miller, starting at the given offset. This is the generator that
+     * backs rand() on macOS. Hence, a track at byte offset t * trackSize is
+     * filled exactly as if rand() had been seeded with 0 and called for the
+     * whole disk, no matter in which order the tracks are encoded. The global
+     * state of rand() is not touched.
+     */
+    static void fillWithNoise(u8 *dst, size_t count, u64 offset);
+    
+
     //
     // Encoding
     //
     
 public:
     
-    // Encodes a disk
+    /* Encodes a disk. The sector data is copied into the disk and the tracks
+     * are encoded one by one when they are accessed for the first time.
+     */
     bool encodeDisk(class DiskFile *df);
     
+    // Encodes all tracks that haven't been encoded yet
+    void encodeAllTracks();
+    
 private:
     
-    // Encodes a disk, track, or sector in Amiga format
-    bool encodeAmigaDisk(class DiskFile *df);
-    bool encodeAmigaTrack(class DiskFile *df, Track t);
-    bool encodeAmigaSector(class DiskFile *df, Track t, Sector s);
+    // Encodes a single track (called on the first access)
+    void encodeTrack(Track t);
+    
+    // Encodes a track or a sector in Amiga format
+    bool encodeAmigaTrack(Track t);
+    bool encodeAmigaSector(Track t, Sector s);
 
-    // Encodes a disk, track, or sector in DOS format
-    bool encodeDosDisk(class DiskFile *df);
-    bool encodeDosTrack(class DiskFile *df, Track t);
-    bool encodeDosSector(class DiskFile *df, Track t, Sector s);
+    // Encodes a track or a sector in DOS format
+    bool encodeDosTrack(Track t);
+    bool encodeDosSector(Track t, Sector s);
 
     
     //
@@ -148,16 +254,24 @@ private:
 
 public:
     
-    // Decodes a disk, track, or sector in Amiga format
+    /* Decodes a disk, track, or sector in Amiga format. Only tracks that have
+     * been written to are decoded. All other sectors are taken from the
+     * source image.
+     */
     bool decodeAmigaDisk(u8 *dst, long numTracks, long numSectors);
     bool decodeAmigaTrack(u8 *dst, Track t, long numSectors);
     bool decodeAmigaSector(u8 *dst, u8 *src);
 
-    // Decodes a disk, track, or sector in Amiga format
+    // Decodes a disk, track, or sector in DOS format
     bool decodeDOSDisk(u8 *dst, long numTracks, long numSectors);
     bool decodeDOSTrack(u8 *dst, Track t, long numSectors);
     void decodeDOSSector(u8 *dst, u8 *src);
 
+private:
+    
+    // Checks if a track can be exported by copying it from the source image
+    bool isCleanTrack(Track t, long numSectors);
+    
     
     //
     // Encoding and decoding MFM data
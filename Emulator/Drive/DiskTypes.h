@@ -53,6 +53,30 @@ inline const char *diskTypeName(DiskType type)
     }
 }
 
+typedef VA_ENUM(long, MFMCodec)
+{
+    MFM_SCALAR,
+    MFM_LUT,
+    MFM_BMI2
+};
+
+inline bool isMFMCodec(MFMCodec codec)
+{
+    return codec >= MFM_SCALAR && codec <= MFM_BMI2;
+}
+
+inline const char *mfmCodecName(MFMCodec codec)
+{
+    assert(isMFMCodec(codec));
+
+    switch (codec) {
+        case MFM_SCALAR: return "Scalar";
+        case MFM_LUT:    return "LUT";
+        case MFM_BMI2:   return "BMI2";
+        default:         return "???";
+    }
+}
+
 typedef VA_ENUM(long, EmptyDiskFormat)
 {
     FS_EMPTY,
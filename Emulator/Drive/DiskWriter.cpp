@@ -0,0 +1,241 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+
+DiskWriter::DiskWriter()
+{
+    setDescription("DiskWriter");
+}
+
+DiskWriter::~DiskWriter()
+{
+    detach();
+    
+    // Let the writer thread finish all pending jobs
+    if (writerThread.joinable()) {
+        
+        {   std::lock_guard<std::mutex> lock(jobMutex);
+            quit = true;
+        }
+        wakeUp.notify_one();
+        writerThread.join();
+    }
+}
+
+bool
+DiskWriter::attach(Disk *disk, const char *filename)
+{
+    assert(disk != nullptr);
+    assert(filename != nullptr);
+    
+    detach();
+    
+    // Wait until a previous backing file has been closed
+    sync();
+    
+    // Only the standard cylinders are stored in ADF and IMG files
+    Session *s = new Session { strdup(filename), nullptr, 0, 0 };
+    s->numTracks = 80 * disk->geometry.sides;
+    s->numSectors = disk->geometry.sectors;
+    
+    // Export the complete disk once
+    s->image = new u8[s->numTracks * s->numSectors * 512];
+    bool success = isAmigaDiskType(disk->getType()) ?
+    disk->decodeAmigaDisk(s->image, s->numTracks, s->numSectors) :
+    disk->decodeDOSDisk(s->image, s->numTracks, s->numSectors);
+    
+    // The writer thread is idle, so we can write the file directly
+    if (!success || !writeImage(s)) {
+        
+        warn("Failed to attach %s\n", filename);
+        close(s);
+        return false;
+    }
+    
+    // From now on, only modified tracks need to be written
+    for (Track t = 0; t < disk->geometry.tracks; t++) disk->unsaved[t] = false;
+    
+    path = strdup(filename);
+    numTracks = s->numTracks;
+    numSectors = s->numSectors;
+    
+    // Hand the session over to the writer thread
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        session = s;
+    }
+    
+    // Launch the writer thread
+    if (!writerThread.joinable()) {
+        
+        quit = false;
+        writerThread = std::thread(&DiskWriter::main, this);
+    }
+    
+    debug(FILE_DEBUG, "Attached %s\n", path);
+    return true;
+}
+
+void
+DiskWriter::detach()
+{
+    if (!isAttached()) return;
+    
+    debug(FILE_DEBUG, "Detaching %s\n", path);
+    
+    // Let the writer thread close the file after all pending writes
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        pending.push_back(Job { -1, { } });
+    }
+    wakeUp.notify_one();
+    
+    free(path);
+    path = nullptr;
+}
+
+void
+DiskWriter::flush(Disk *disk)
+{
+    assert(disk != nullptr);
+    
+    if (!isAttached()) return;
+    
+    vector<Job> jobs;
+    bool amiga = isAmigaDiskType(disk->getType());
+    
+    for (Track t = 0; t < numTracks; t++) {
+        
+        if (!disk->unsaved[t]) continue;
+        disk->unsaved[t] = false;
+        
+        Job job { t, vector<u8>(numSectors * 512) };
+        bool success = amiga ?
+        disk->decodeAmigaTrack(job.data.data(), t, numSectors) :
+        disk->decodeDOSTrack(job.data.data(), t, numSectors);
+        
+        if (success) {
+            jobs.push_back(std::move(job));
+            continue;
+        }
+        
+        // Keep the track and try again in the next call
+        warn("Failed to decode track %d of %s\n", t, path);
+        disk->unsaved[t] = true;
+        errors++;
+    }
+    
+    if (jobs.empty()) return;
+    
+    // Hand the decoded tracks over to the writer thread
+    {   std::lock_guard<std::mutex> lock(jobMutex);
+        for (auto &job : jobs) pending.push_back(std::move(job));
+    }
+    wakeUp.notify_one();
+}
+
+void
+DiskWriter::sync()
+{
+    if (!writerThread.joinable()) return;
+    
+    std::unique_lock<std::mutex> lock(jobMutex);
+    done.wait(lock, [&]{ return pending.empty() && !busy; });
+}
+
+void
+DiskWriter::main()
+{
+    vector<Job> jobs;
+    
+    while (true) {
+        
+        Session *s;
+        
+        // Wait for work
+        {   std::unique_lock<std::mutex> lock(jobMutex);
+            wakeUp.wait(lock, [&]{ return quit || !pending.empty(); });
+            
+            if (pending.empty()) break;
+            jobs.swap(pending);
+            s = session;
+            busy = true;
+        }
+        
+        long written = 0;
+        bool modified = false, success = true;
+        
+        for (auto &job : jobs) {
+            
+            if (!s) continue;
+            
+            if (job.isClose()) {
+                
+                // Write the remaining tracks and close the file
+                if (modified) success &= writeImage(s);
+                debug(FILE_DEBUG, "Closed %s\n", s->path);
+                close(s);
+                s = nullptr;
+                modified = false;
+                continue;
+            }
+            
+            // Merge the decoded track into the image
+            memcpy(s->image + job.track * s->numSectors * 512, job.data.data(), job.data.size());
+            modified = true;
+            written++;
+        }
+        if (modified) success &= writeImage(s);
+        
+        {   std::lock_guard<std::mutex> lock(jobMutex);
+            if (!s) session = nullptr;
+            if (success && written) { flushes++; tracks += written; }
+            busy = false;
+        }
+        done.notify_all();
+        jobs.clear();
+    }
+}
+
+bool
+DiskWriter::writeImage(Session *s)
+{
+    size_t size = s->numTracks * s->numSectors * 512;
+    
+    // Assemble the name of the temporary file
+    char *tmp = new char[strlen(s->path) + 5];
+    strcpy(tmp, s->path);
+    strcat(tmp, ".tmp");
+    
+    // Write the image to the temporary file
+    bool success = false;
+    if (FILE *file = fopen(tmp, "w")) {
+        
+        success = fwrite(s->image, 1, size, file) == size;
+        success &= fflush(file) == 0 && fsync(fileno(file)) == 0;
+        success &= fclose(file) == 0;
+    }
+    
+    // Replace the backing file
+    if (success) success = rename(tmp, s->path) == 0;
+    if (!success) {
+        warn("Failed to write %s\n", s->path);
+        remove(tmp);
+    }
+    
+    delete [] tmp;
+    return success;
+}
+
+void
+DiskWriter::close(Session *s)
+{
+    free(s->path);
+    delete [] s->image;
+    delete s;
+}
@@ -0,0 +1,141 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _DISK_WRITER_H
+#define _DISK_WRITER_H
+
+#include "Disk.h"
+#include <condition_variable>
+
+/* The disk writer keeps a backing file (ADF or IMG) in sync with a disk.
+ * At regular intervals, the emulator thread calls flush(), which decodes
+ * all tracks that have been written to since the last call. The decoded
+ * sector data is handed over to a background thread. That thread merges it
+ * into its copy of the image and replaces the backing file. The file is
+ * replaced in a crash-safe way: the image is written to a temporary file
+ * first, which is then renamed to the backing file.
+ *
+ * Detaching never blocks the caller. The connection is closed by a job that
+ * is processed by the writer thread after all previously scheduled tracks
+ * have been written.
+ */
+class DiskWriter : public AmigaObject {
+    
+    // The backing file as seen by the writer thread
+    struct Session {
+        
+        char *path;
+        u8 *image;
+        long numTracks;
+        long numSectors;
+    };
+    
+    // A decoded track waiting to be written or a request to close the file
+    struct Job {
+        
+        Track track;
+        vector<u8> data;
+        
+        bool isClose() const { return track < 0; }
+    };
+    
+    // Location of the backing file (NULL if no file is attached)
+    char *path = nullptr;
+    
+    // Geometry of the attached disk
+    long numTracks = 0;
+    long numSectors = 0;
+    
+    // The currently processed backing file (only accessed by the writer thread)
+    Session *session = nullptr;
+    
+    // Jobs waiting to be processed
+    vector<Job> pending;
+    
+    // The writer thread
+    std::thread writerThread;
+    
+    // Synchronization primitives
+    std::mutex jobMutex;
+    std::condition_variable wakeUp;
+    std::condition_variable done;
+    
+    // Indicates if the writer thread is writing
+    bool busy = false;
+    
+    // Indicates if the writer thread is supposed to terminate
+    bool quit = false;
+    
+    // Number of completed file updates and written tracks
+    long flushes = 0;
+    long tracks = 0;
+    
+    // Number of tracks that could not be decoded
+    long errors = 0;
+    
+    
+    //
+    // Initializing
+    //
+    
+public:
+    
+    DiskWriter();
+    ~DiskWriter();
+    
+    
+    //
+    // Managing the backing file
+    //
+    
+public:
+    
+    /* Connects a disk with a backing file. The complete disk is exported to
+     * the file once. Afterwards, only modified tracks are written.
+     */
+    bool attach(Disk *disk, const char *path);
+    
+    // Closes the connection once all pending tracks have been written
+    void detach();
+    
+    // Checks if a backing file is attached
+    bool isAttached() { return path != nullptr; }
+    const char *getPath() { return path ? path : ""; }
+    
+    // Returns the number of file updates and written tracks
+    long getFlushes() { return flushes; }
+    long getTracks() { return tracks; }
+    long getErrors() { return errors; }
+    
+    
+    //
+    // Writing
+    //
+    
+public:
+    
+    // Decodes all unsaved tracks and schedules them for writing
+    void flush(Disk *disk);
+    
+    // Waits until all scheduled tracks have been written
+    void sync();
+    
+private:
+    
+    // Main loop of the writer thread
+    void main();
+    
+    // Writes the image of a session to the backing file
+    bool writeImage(Session *s);
+    
+    // Frees a session
+    void close(Session *s);
+};
+
+#endif
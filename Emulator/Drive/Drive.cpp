@@ -22,6 +22,7 @@ Drive::Drive(unsigned n, Amiga& ref) : nr(n), AmigaComponent(ref)
     config.startDelay = MSEC(380);
     config.stopDelay = MSEC(80);
     config.stepDelay = USEC(2000);
+    config.flushInterval = 1000;
 }
 
 void
@@ -37,6 +38,7 @@ Drive::getConfigItem(ConfigOption option)
             
         case OPT_DRIVE_TYPE:        return (long)config.type;
         case OPT_EMULATE_MECHANICS: return (long)config.mechanicalDelays;
+        case OPT_FLUSH_INTERVAL:    return (long)config.flushInterval;
             
         default: assert(false);
     }
@@ -77,6 +79,20 @@ Drive::setConfigItem(unsigned dfn, ConfigOption option, long value)
             trace("Setting emulateMechanics to %d\n", config.mechanicalDelays);
             return true;
 
+        case OPT_FLUSH_INTERVAL:
+        
+            if (value < 0) {
+                warn("Invalid flush interval: %d\n", value);
+                return false;
+            }
+            if (config.flushInterval == value) {
+                return false;
+            }
+            
+            config.flushInterval = value;
+            trace("Setting flush interval to %d msec\n", config.flushInterval);
+            return true;
+
         default:
             return false;
     }
@@ -101,6 +117,7 @@ Drive::_dumpConfig()
     msg("       Start delay : %d\n", config.startDelay);
     msg("        Stop delay : %d\n", config.stopDelay);
     msg("        Step delay : %d\n", config.stepDelay);
+    msg("    Flush interval : %d msec\n", config.flushInterval);
 }
 
 void
@@ -123,6 +140,7 @@ Drive::_dump()
     msg("            Offset: %d\n", head.offset);
     msg("   cylinderHistory: %X\n", cylinderHistory);
     msg("              Disk: %s\n", disk ? "yes" : "no");
+    msg("      Backing file: %s\n", writer.getPath());
     
     if (disk) disk->dump();
 }
@@ -144,7 +162,7 @@ Drive::_size()
         // Add the disk type and disk state
         counter & disk->getType();
         disk->applyToPersistentItems(counter);
-        counter.count += disk->geometry.diskSize;
+        counter.count += disk->sizeOfTracks();
     }
 
     return counter.count;
@@ -160,8 +178,10 @@ Drive::_load(u8 *buffer)
     applyToHardResetItems(reader);
     applyToResetItems(reader);
 
-    // Delete the current disk
+    // Write back all modifications and delete the current disk
     if (disk) {
+        writer.flush(disk);
+        writer.detach();
         delete disk;
         disk = NULL;
     }
@@ -184,28 +204,28 @@ Drive::_load(u8 *buffer)
 size_t
 Drive::_save(u8 *buffer)
 {
-    SerWriter writer(buffer);
+    SerWriter serializer(buffer);
 
     // Write own state
-    applyToPersistentItems(writer);
-    applyToHardResetItems(writer);
-    applyToResetItems(writer);
+    applyToPersistentItems(serializer);
+    applyToHardResetItems(serializer);
+    applyToResetItems(serializer);
 
     // Indicate whether this drive has a disk is inserted
-    writer & hasDisk();
+    serializer & hasDisk();
 
     if (hasDisk()) {
 
         // Write the disk type
-        writer & disk->getType();
+        serializer & disk->getType();
 
         // Write the disk's state
-        disk->applyToPersistentItems(writer);
-        writer.copy(disk->data, disk->geometry.diskSize);
+        disk->applyToPersistentItems(serializer);
+        disk->saveTracks(serializer);
     }
 
-    trace(SNP_DEBUG, "Serialized to %d bytes\n", writer.ptr - buffer);
-    return writer.ptr - buffer;
+    trace(SNP_DEBUG, "Serialized to %d bytes\n", serializer.ptr - buffer);
+    return serializer.ptr - buffer;
 }
 
 bool
@@ -352,8 +372,14 @@ Drive::selectSide(int side)
     head.side = side;
 }
 
+bool
+Drive::isStepping(Cycle cycle)
+{
+    return config.mechanicalDelays && (cycle - stepCycle) < config.stepDelay;
+}
+
 u8
-Drive::readByte()
+Drive::peekByte(u16 offset, Cycle cycle)
 {
     // Case 1: No disk is inserted
     if (!disk) {
@@ -361,12 +387,18 @@ Drive::readByte()
     }
 
     // Case 2: A step operation is in progress
-    if (config.mechanicalDelays && (agnus.clock - stepCycle) < config.stepDelay) {
+    if (isStepping(cycle)) {
       return 0xFF;
     }
     
     // Case 3: Normal operation
-    return disk->readByte(head.cylinder, head.side, head.offset);
+    return disk->readByte(head.cylinder, head.side, offset);
+}
+
+u8
+Drive::readByte()
+{
+    return peekByte(head.offset, agnus.clock);
 }
 
 u8
@@ -386,6 +418,25 @@ Drive::readWordAndRotate()
     return HI_LO(byte1, byte2);
 }
 
+void
+Drive::readBlockAndRotate(u8 *dst, long count)
+{
+    assert(disk);
+    
+    u8 *src = disk->ptr(2 * head.cylinder + head.side);
+    long length = disk->geometry.trackSize;
+    
+    // Copy the data in chunks, starting over at the end of the track
+    for (long offset = head.offset, chunk; count > 0; offset = 0) {
+        
+        chunk = MIN(count, length - offset);
+        memcpy(dst, src + offset, chunk);
+        dst += chunk;
+        count -= chunk;
+        if (motor) rotate(chunk);
+    }
+}
+
 void
 Drive::writeByte(u8 value)
 {
@@ -424,15 +475,56 @@ Drive::rotate()
     }
 }
 
+void
+Drive::rotate(long count)
+{
+    long offset = head.offset + count;
+    
+    // Without a disk, the head offset wraps over silently (as in rotate())
+    if (!disk) {
+        head.offset = (u16)offset;
+        return;
+    }
+    
+    for (long last = disk->geometry.trackSize; offset >= last; offset -= last) {
+        if (isSelected()) ciab.emulateFallingEdgeOnFlagPin();
+    }
+    head.offset = (u16)offset;
+}
+
 void
 Drive::findSyncMark()
 {
-    for (unsigned i = 0; i < disk->geometry.trackSize; i++) {
+    // The head doesn't move if no disk is inserted or the motor is off
+    if (!disk || !motor) return;
+    
+    Track t = 2 * head.cylinder + head.side;
+    long length = disk->getTrackSize();
+    
+    // While the head is stepping, the drive delivers no data (0xFF)
+    if (isStepping(agnus.clock)) {
         
-        if (readByteAndRotate() != 0x44) continue;
-        if (readByteAndRotate() != 0x89) continue;
-        break;
+        rotate(length);
+        trace(DSK_DEBUG, "No SYNC mark found (head is stepping)\n");
+        return;
     }
+    
+    // Look up the next SYNC mark, starting with the next byte to read
+    long pos = disk->nextSyncMark(t, 0x4489, head.offset + 1);
+    if (pos < 0) pos = disk->nextSyncMark(t, 0x4489, 0);
+    
+    if (pos < 0) {
+        
+        // Spin the disk once if there is no SYNC mark on this track
+        rotate(length);
+        trace(DSK_DEBUG, "No SYNC mark found\n");
+        return;
+    }
+    
+    // Move the head behind the SYNC mark
+    long count = pos + 1 - head.offset;
+    if (count <= 0) count += length;
+    rotate(count);
 
     trace(DSK_DEBUG, "Moving to SYNC mark at offset %d\n", head.offset);
 }
@@ -576,9 +668,15 @@ Drive::ejectDisk()
         // Flag disk change in the CIAA::PA
         dskchange = false;
         
+        // Write back all modifications
+        writer.flush(disk);
+        writer.detach();
+        
         // Get rid of the disk
+        diskController.catchUp();
         delete disk;
         disk = NULL;
+        diskController.scheduleNextDiskEvent();
         
         // Notify the GUI
         messageQueue.put(MSG_DISK_EJECT, nr);
@@ -635,7 +733,9 @@ Drive::insertDisk(Disk *disk)
         assert(!hasDisk());
 
         // Insert the disk and inform the GUI
+        diskController.catchUp();
         this->disk = disk;
+        diskController.scheduleNextDiskEvent();
         messageQueue.put(MSG_DISK_INSERT, nr);
         
         return true;
@@ -650,6 +750,64 @@ Drive::fnv()
     return disk ? disk->getFnv() : 0;
 }
 
+bool
+Drive::setBackingFile(const char *path)
+{
+    assert(path != nullptr);
+    
+    bool result = false;
+    
+    amiga.suspend();
+    
+    if (disk) {
+        result = writer.attach(disk, path);
+        flushCycle = agnus.clock;
+    }
+    
+    amiga.resume();
+    return result;
+}
+
+void
+Drive::clearBackingFile()
+{
+    amiga.suspend();
+    
+    if (disk) writer.flush(disk);
+    writer.detach();
+    
+    amiga.resume();
+}
+
+void
+Drive::flushDisk()
+{
+    amiga.suspend();
+    
+    if (disk) {
+        writer.flush(disk);
+        writer.sync();
+    }
+    
+    amiga.resume();
+}
+
+void
+Drive::vsyncHandler()
+{
+    if (!disk || !writer.isAttached()) return;
+    
+    // The clock may have been reset by loading a snapshot
+    if (flushCycle > agnus.clock) flushCycle = agnus.clock;
+    
+    if (agnus.clock - flushCycle >= MSEC(config.flushInterval)) {
+        
+        // Hand the modified tracks over to the writer thread
+        writer.flush(disk);
+        flushCycle = agnus.clock;
+    }
+}
+
 void
 Drive::PRBdidChange(u8 oldValue, u8 newValue)
 {
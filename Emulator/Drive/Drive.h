@@ -12,6 +12,7 @@
 
 #include "AmigaComponent.h"
 #include "Disk.h"
+#include "DiskWriter.h"
 
 class Drive : public AmigaComponent {
     
@@ -66,6 +67,12 @@ class Drive : public AmigaComponent {
      * device to detect a newly inserted disk.
      */
     u64 cylinderHistory;
+    
+    // Writes modified tracks back to a backing file
+    DiskWriter writer;
+    
+    // Time stamp of the latest write-back
+    Cycle flushCycle = 0;
 
 public:
     
@@ -210,10 +217,19 @@ public:
     // Selects the active drive head (0 = lower, 1 = upper)
     void selectSide(int side);
 
+    // Checks if the drive head is moving to another cylinder
+    bool isStepping(Cycle cycle);
+    
+    // Returns the byte the drive head delivers at a certain offset and time
+    u8 peekByte(u16 offset, Cycle cycle);
+
     // Reads a value from the drive head and optionally rotates the disk
     u8 readByte();
     u8 readByteAndRotate();
     u16 readWordAndRotate();
+    
+    // Reads a block of bytes from the drive head and rotates the disk
+    void readBlockAndRotate(u8 *dst, long count);
 
     // Writes a value to the drive head and optionally rotates the disk
     void writeByte(u8 value);
@@ -222,6 +238,9 @@ public:
 
     // Emulate a disk rotation (moves head to the next byte)
     void rotate();
+    
+    // Emulates multiple disk rotations at once
+    void rotate(long count);
 
     // Rotates the disk to the next sync mark
     void findSyncMark();
@@ -268,6 +287,27 @@ public:
     
     u64 fnv();
     
+    
+    //
+    // Writing back modified disks
+    //
+    
+public:
+    
+    /* Connects the inserted disk with a backing file. Modified tracks are
+     * written to this file periodically (see OPT_FLUSH_INTERVAL) and when the
+     * disk is ejected. The connection is closed when the disk is ejected.
+     */
+    bool setBackingFile(const char *path);
+    void clearBackingFile();
+    const char *getBackingFile() { return writer.getPath(); }
+    
+    // Writes back all modified tracks and waits until the file is updated
+    void flushDisk();
+    
+    // Called by Agnus at the end of each frame
+    void vsyncHandler();
+    
     //
     // Delegation methods
     //
@@ -70,6 +70,9 @@ typedef struct
     Cycle startDelay;
     Cycle stopDelay;
     Cycle stepDelay;
+    
+    // Time between two write-backs to the backing file in milliseconds
+    long flushInterval;
 }
 DriveConfig;
 
@@ -24,6 +24,10 @@ class Disk;
 
 class ADFFile : public DiskFile {
     
+    // Converted archives and directories are written directly into the data
+    friend class DMSFile;
+    friend class DIRFile;
+    
 public:
     
     //
@@ -127,57 +127,38 @@ AmigaFile::readFromFile(const char *filename)
 {
     assert (filename != NULL);
     
-    bool success = false;
-    u8 *buffer = NULL;
-    FILE *file = NULL;
-    struct stat fileProperties;
+    const u8 *buffer;
+    size_t length;
+    bool mapped;
     
+    u64 start = nanos();
+
     // Check file type
     if (!fileHasSameType(filename)) {
-        goto exit;
-    }
-    
-    // Get file properties
-    if (stat(filename, &fileProperties) != 0) {
-        goto exit;
-    }
-    
-    // Open file
-    if (!(file = fopen(filename, "r"))) {
-        goto exit;
-    }
-    
-    // Allocate memory
-    if (!(buffer = new u8[fileProperties.st_size])) {
-        goto exit;
+        return false;
     }
     
-    // Read from file
-    int c;
-    for (unsigned i = 0; i < fileProperties.st_size; i++) {
-        c = fgetc(file);
-        if (c == EOF)
-            break;
-        buffer[i] = (u8)c;
+    // Map the file into memory
+    if (!mapFile(filename, &buffer, &length, &mapped)) {
+        return false;
     }
     
-    // Read from buffer
+    // Parse the mapped region
     dealloc();
-    if (!readFromBuffer(buffer, (unsigned)fileProperties.st_size)) {
-        goto exit;
+    bool success = readFromBuffer(buffer, length);
+    unmapFile(buffer, length, mapped);
+    
+    if (!success) {
+        return false;
     }
     
     setPath(filename);
-    success = true;
-        
-exit:
     
-    if (file)
-        fclose(file);
-    if (buffer)
-        delete[] buffer;
-    
-    return success;
+    debug(FILE_DEBUG, "Loaded %zu bytes from %s in %.3f msec (%s)\n",
+          length, filename, (nanos() - start) / 1000000.0,
+          mapped ? "mapped" : "bulk read");
+
+    return true;
 }
 
 bool
@@ -185,39 +166,36 @@ AmigaFile::readFromFile(FILE *file)
 {
     assert (file != NULL);
     
-    u8 *buffer = NULL;
+    const u8 *buffer;
+    size_t length;
+    bool mapped;
 
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    size_t size = (size_t)ftell(file);
-    rewind(file);
-    
-    // Allocate memory
-    if (!(buffer = new u8[size])) {
-        return false;
-    }
+    u64 start = nanos();
 
-    // Read from file
-    int c;
-    for (unsigned i = 0; i < size; i++) {
-        if ((c = fgetc(file)) == EOF) break;
-        buffer[i] = (u8)c;
+    // Map the file into memory
+    if (!mapFile(file, &buffer, &length, &mapped)) {
+        return false;
     }
 
     // Check type
-    if (!bufferHasSameType(buffer, size)) {
-        delete[] buffer;
+    if (!bufferHasSameType(buffer, length)) {
+        unmapFile(buffer, length, mapped);
         return false;
     }
     
-    // Read from buffer
+    // Parse the mapped region
     dealloc();
-    if (!readFromBuffer(buffer, size)) {
-        delete[] buffer;
+    bool success = readFromBuffer(buffer, length);
+    unmapFile(buffer, length, mapped);
+    
+    if (!success) {
         return false;
     }
     
-    delete[] buffer;
+    debug(FILE_DEBUG, "Loaded %zu bytes in %.3f msec (%s)\n",
+          length, (nanos() - start) / 1000000.0,
+          mapped ? "mapped" : "bulk read");
+
     return true;
 }
 
@@ -255,8 +233,7 @@ AmigaFile::writeToFile(const char *filename)
     if (!writeToBuffer(data)) goto exit;
     
     // Write the buffer to a file
-    for (unsigned i = 0; i < filesize; i++) fputc(data[i], file);
-    success = true;
+    success = fwrite(data, 1, filesize, file) == filesize;
     
 exit:
     
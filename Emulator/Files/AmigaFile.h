@@ -112,15 +112,18 @@ public:
     
     /* Deserializes this object from a memory buffer. This function uses
      * bufferHasSameType() to verify that the buffer contains a compatible
-     * binary representation.
+     * binary representation. The default implementation copies the buffer.
+     * File types that only parse their input may override this function and
+     * work on the buffer in place, as it stays valid until the function
+     * returns.
      */
     virtual bool readFromBuffer(const u8 *buffer, size_t length);
     
     /* Deserializes this object from a file. This function uses
      * fileHasSameType() to verify that the file contains a compatible binary
      * representation. This function requires no custom implementation. It
-     * first reads in the file contents in memory and invokes readFromBuffer
-     * afterwards.
+     * maps the file into memory and invokes readFromBuffer on the mapped
+     * region. The mapping is released once readFromBuffer returns.
      */
     virtual bool readFromFile(const char *filename);
 
@@ -8,8 +8,10 @@
 // -----------------------------------------------------------------------------
 
 #include <dirent.h>
+#include <filesystem>
 #include "DIRFile.h"
 #include "FSVolume.h"
+#include "DiskCache.h"
 
 namespace fs = std::filesystem;
 
@@ -65,6 +67,23 @@ DIRFile::readFromFile(const char *filename)
         return false;
     }
     
+    // Check if the directory has been converted before
+    DiskCache &cache = DiskCache::shared();
+    u64 key = DiskCache::makeKey(fingerprint(filename), DiskCache::KEY_DIR);
+    
+    size_t cached = cache.sizeOf(key);
+    if (cached && ADFFile::isADFBuffer(NULL, cached)) {
+        
+        adf = new ADFFile();
+        if (adf->alloc(cached) && cache.lookup(key, adf->data, cached)) {
+            
+            debug(FILE_DEBUG, "Took %zu bytes from the disk cache\n", cached);
+            return true;
+        }
+        delete adf;
+        adf = nullptr;
+    }
+    
     // Create a new file system
     OFSVolume volume = OFSVolume("Disk", 2 * 880);
     
@@ -89,9 +108,44 @@ DIRFile::readFromFile(const char *filename)
     assert(adf == nullptr);
     if (success) adf = ADFFile::makeWithVolume(volume);
     debug("adf = %p\n", adf); 
+    
+    if (adf) cache.store(key, adf->data, adf->size);
     return adf != nullptr;
 }
 
+u64
+DIRFile::fingerprint(const char *dir)
+{
+    assert(dir != nullptr);
+    
+    std::error_code ec;
+    u64 result = fnv_1a_64((const u8 *)dir, strlen(dir));
+    
+    auto it = fs::recursive_directory_iterator(dir, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        
+        // Skip all hidden items (they are ignored by traverseDir, too)
+        std::string name = it->path().filename().string();
+        if (name[0] == '.') {
+            if (it->is_directory(ec)) it.disable_recursion_pending();
+            continue;
+        }
+        
+        std::string path = it->path().string();
+        u64 hash = fnv_1a_64((const u8 *)path.c_str(), path.length());
+        
+        if (it->is_regular_file(ec)) {
+            hash = fnv_1a_it64(hash, (u64)it->file_size(ec));
+            hash = fnv_1a_it64(hash, (u64)it->last_write_time(ec).time_since_epoch().count());
+        }
+        
+        // Combine the hashes independently of the traversal order
+        result += hash;
+    }
+    
+    return result;
+}
+
 bool 
 DIRFile::traverseDir(const char *dir, FSVolume &vol) {
     
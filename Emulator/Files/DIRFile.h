@@ -52,6 +52,13 @@ private:
     
     bool traverseDir(const char *dir, FSVolume &vol);
     
+    /* Computes a fingerprint of a directory tree. The fingerprint covers the
+     * names, sizes, and modification dates of all files that are imported by
+     * traverseDir(). It is used to look up the converted volume in the disk
+     * cache.
+     */
+    static u64 fingerprint(const char *dir);
+    
     
     //
     // Methods from DiskFile
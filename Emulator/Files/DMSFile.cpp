@@ -8,9 +8,10 @@
 // -----------------------------------------------------------------------------
 
 #include "DMSFile.h"
+#include "DiskCache.h"
 
 extern "C" {
-unsigned short extractDMS(FILE *fi, FILE *fo);
+unsigned short extractDMSFromBuffer(const u8 *in, u32 inlen, u8 *out, u32 *outlen);
 }
 
 DMSFile::DMSFile()
@@ -67,38 +68,58 @@ DMSFile::makeWithFile(const char *path)
 bool
 DMSFile::readFromBuffer(const u8 *buffer, size_t length)
 {
-    FILE *fpi, *fpo;
-    char *pi, *po;
-    size_t si, so;
+    u32 adfSize;
     
     if (!isDMSBuffer(buffer, length))
         return false;
+    
+    // We use a third-party tool called xdms to convert the DMS file into an
+    // ADF file. The tool scans the archive in a first pass to determine the
+    // size of the disk image. In the second pass, it unpacks the tracks
+    // directly into the data buffer of the ADF. The archive is read in place
+    // and not copied, since only the ADF is kept.
+    
+    u64 start = nanos();
+    
+    // Check if this archive has been unpacked before
+    DiskCache &cache = DiskCache::shared();
+    u64 key = DiskCache::makeKey(fnv_1a_64(buffer, length), DiskCache::KEY_DMS);
+    
+    size_t cached = cache.sizeOf(key);
+    if (cached && ADFFile::isADFBuffer(NULL, cached)) {
         
-    if (!AmigaFile::readFromBuffer(buffer, length))
+        adf = new ADFFile();
+        if (adf->alloc(cached) && cache.lookup(key, adf->data, cached)) {
+            
+            debug(FILE_DEBUG, "Took %zu bytes from the disk cache\n", cached);
+            return true;
+        }
+        delete adf;
+        adf = NULL;
+    }
+    
+    // Determine the size of the unpacked disk
+    if (extractDMSFromBuffer(buffer, (u32)length, NULL, &adfSize) != 0)
         return false;
     
-    // We use a third-party tool called xdms to convert the DMS file into an
-    // ADF file. Originally, xdms is a command line utility that is designed
-    // to work with the file system. To ease the integration of this tool, we
-    // utilize memory streams for getting data in and out. 
-
-    // Setup input stream
-    fpi = open_memstream(&pi, &si);
-    for (size_t i = 0; i < size; i++) putc(data[i], fpi);
-    fclose(fpi);
-    
-    // Setup output file
-    fpi = fmemopen(pi, si, "r");
-    fpo = open_memstream(&po, &so);
-    extractDMS(fpi, fpo);
-    fclose(fpi);
-    fclose(fpo);
+    if (!ADFFile::isADFBuffer(NULL, adfSize))
+        return false;
     
     // Create ADF
-    fpo = fmemopen(po, so, "r");
-    adf = ADFFile::makeWithFile(fpo);
-    fclose(fpo);
+    adf = new ADFFile();
+    if (!adf->alloc(adfSize) ||
+        extractDMSFromBuffer(buffer, (u32)length, adf->data, &adfSize) != 0 ||
+        adfSize != adf->size) {
+        
+        delete adf;
+        adf = NULL;
+        return false;
+    }
+    
+    debug(FILE_DEBUG, "Unpacked %u bytes in %.3f msec\n",
+          adfSize, (nanos() - start) / 1000000.0);
     
-    return adf != NULL;
+    cache.store(key, adf->data, adf->size);
+    
+    return true;
 }
-
@@ -47,6 +47,7 @@ public:
     AmigaFileType fileType() override { return FILETYPE_DMS; }
     const char *typeAsString() override { return "DMS"; }
     u64 fnv() override { return adf->fnv(); }
+    size_t writeToBuffer(u8 *buffer) override { return adf->writeToBuffer(buffer); }
     bool bufferHasSameType(const u8 *buffer, size_t length) override {
         return isDMSBuffer(buffer, length); }
     bool fileHasSameType(const char *path) override { return isDMSFile(path); }
@@ -0,0 +1,340 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "DiskCache.h"
+#include <algorithm>
+#include <cinttypes>
+#include <filesystem>
+#include <vector>
+#include <sys/time.h>
+
+namespace fs = std::filesystem;
+
+DiskCache &
+DiskCache::shared()
+{
+    static DiskCache cache;
+    return cache;
+}
+
+DiskCache::DiskCache()
+{
+    setDescription("DiskCache");
+    memset(&stats, 0, sizeof(stats));
+}
+
+DiskCache::~DiskCache()
+{
+    clear();
+    if (directory) free(directory);
+}
+
+u64
+DiskCache::makeKey(u64 fnv, u64 category, u64 param1, u64 param2)
+{
+    u64 key = fnv_1a_it64(fnv_1a_init64(), fnv);
+    key = fnv_1a_it64(key, category);
+    key = fnv_1a_it64(key, param1);
+    key = fnv_1a_it64(key, param2);
+    
+    return key;
+}
+
+void
+DiskCache::setCapacity(size_t bytes)
+{
+    synchronized {
+        
+        capacity = bytes;
+        shrink();
+    }
+}
+
+void
+DiskCache::setDirectory(const char *path)
+{
+    synchronized {
+        
+        if (directory) free(directory);
+        directory = (path && *path) ? strdup(path) : nullptr;
+        if (directory) trimDirectory();
+    }
+}
+
+void
+DiskCache::setDirectoryCapacity(size_t bytes)
+{
+    synchronized {
+        
+        directoryCapacity = bytes;
+        if (directory) trimDirectory();
+    }
+}
+
+DiskCacheStats
+DiskCache::getStats()
+{
+    DiskCacheStats result;
+    
+    synchronized {
+        
+        stats.entries = (long)entries.size();
+        stats.bytes = (long)used;
+        result = stats;
+    }
+    return result;
+}
+
+void
+DiskCache::clear()
+{
+    synchronized {
+        
+        for (auto &it : entries) delete [] it.second.data;
+        entries.clear();
+        lru.clear();
+        used = 0;
+    }
+}
+
+size_t
+DiskCache::sizeOf(u64 key)
+{
+    size_t result = 0;
+    
+    synchronized {
+        
+        Entry *entry = find(key);
+        if (!entry && load(key)) entry = find(key);
+        
+        if (entry) {
+            result = entry->size;
+        } else {
+            stats.misses++;
+        }
+    }
+    return result;
+}
+
+bool
+DiskCache::lookup(u64 key, u8 *buffer, size_t size)
+{
+    assert(buffer != nullptr);
+    
+    bool result = false;
+    
+    synchronized {
+        
+        Entry *entry = find(key);
+        if (!entry && load(key)) entry = find(key);
+        
+        if (entry && entry->size == size) {
+            
+            memcpy(buffer, entry->data, size);
+            stats.hits++;
+            result = true;
+            
+        } else {
+            
+            stats.misses++;
+        }
+    }
+    return result;
+}
+
+void
+DiskCache::store(u64 key, const u8 *buffer, size_t size)
+{
+    assert(buffer != nullptr);
+    
+    synchronized {
+        
+        u8 *copy = new u8[size];
+        memcpy(copy, buffer, size);
+        insert(key, copy, size);
+        
+        // Write the entry to the persistent cache
+        if (directory && save(key, buffer, size)) trimDirectory();
+        
+        debug(FILE_DEBUG, "Cached %zu bytes (key %" PRIx64 ")\n", size, key);
+    }
+}
+
+DiskCache::Entry *
+DiskCache::find(u64 key)
+{
+    auto it = entries.find(key);
+    if (it == entries.end()) return nullptr;
+    
+    // Move the entry to the front of the LRU list
+    lru.splice(lru.begin(), lru, it->second.lru);
+    return &it->second;
+}
+
+void
+DiskCache::insert(u64 key, u8 *buffer, size_t size)
+{
+    // Replace existing entries
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        
+        used -= it->second.size;
+        delete [] it->second.data;
+        lru.erase(it->second.lru);
+        entries.erase(it);
+    }
+    
+    lru.push_front(key);
+    entries[key] = Entry { buffer, size, lru.begin() };
+    used += size;
+    
+    shrink();
+}
+
+void
+DiskCache::shrink()
+{
+    // Never evict the most recently used entry
+    while (used > capacity && entries.size() > 1) {
+        
+        auto it = entries.find(lru.back());
+        assert(it != entries.end());
+        
+        used -= it->second.size;
+        delete [] it->second.data;
+        entries.erase(it);
+        lru.pop_back();
+        stats.evictions++;
+    }
+}
+
+char *
+DiskCache::pathOf(u64 key)
+{
+    assert(directory != nullptr);
+    
+    char *result = (char *)malloc(strlen(directory) + 32);
+    sprintf(result, "%s/%016" PRIx64 ".bin", directory, key);
+    
+    return result;
+}
+
+bool
+DiskCache::save(u64 key, const u8 *buffer, size_t size)
+{
+    FileHeader header = { fileMagic, fileVersion, key, size, fnv_1a_64(buffer, size) };
+    
+    char *path = pathOf(key);
+    char *tmp = (char *)malloc(strlen(path) + 5);
+    sprintf(tmp, "%s.tmp", path);
+    
+    // Write into a temporary file which replaces the old one when complete
+    bool success = false;
+    if (FILE *file = fopen(tmp, "w")) {
+        
+        success =
+        fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(buffer, 1, size, file) == size &&
+        fflush(file) == 0 &&
+        fsync(fileno(file)) == 0;
+        
+        success &= fclose(file) == 0;
+    }
+    success = success && rename(tmp, path) == 0;
+    
+    if (!success) {
+        warn("Failed to write %s\n", path);
+        unlink(tmp);
+    }
+    
+    free(tmp);
+    free(path);
+    return success;
+}
+
+bool
+DiskCache::load(u64 key)
+{
+    const u8 *buffer;
+    size_t size;
+    bool mapped;
+    
+    if (!directory) return false;
+    
+    char *path = pathOf(key);
+    if (!mapFile(path, &buffer, &size, &mapped)) { free(path); return false; }
+    
+    // Check the integrity of the file
+    FileHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid) {
+        
+        memcpy(&header, buffer, sizeof(header));
+        valid =
+        header.magic == fileMagic &&
+        header.version == fileVersion &&
+        header.key == key &&
+        header.size == size - sizeof(header) &&
+        header.size <= capacity &&
+        header.checksum == fnv_1a_64(buffer + sizeof(header), header.size);
+    }
+    
+    if (!valid) {
+        
+        warn("Discarding corrupted cache file %s\n", path);
+        unmapFile(buffer, size, mapped);
+        unlink(path);
+        free(path);
+        stats.rejected++;
+        return false;
+    }
+    
+    // Copy the mapped file into memory
+    u8 *copy = new u8[header.size];
+    memcpy(copy, buffer + sizeof(header), header.size);
+    unmapFile(buffer, size, mapped);
+    insert(key, copy, header.size);
+    
+    // Mark the file as recently used
+    utimes(path, NULL);
+    free(path);
+    
+    debug(FILE_DEBUG, "Loaded %zu bytes from the persistent cache\n", (size_t)header.size);
+    return true;
+}
+
+void
+DiskCache::trimDirectory()
+{
+    assert(directory != nullptr);
+    
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    std::error_code ec;
+    size_t total = 0;
+    
+    // Collect all cache files
+    for (auto &it : fs::directory_iterator(directory, ec)) {
+        
+        if (it.path().extension() != ".bin") continue;
+        
+        total += (size_t)it.file_size(ec);
+        files.push_back({ it.last_write_time(ec), it.path() });
+    }
+    if (total <= directoryCapacity) return;
+    
+    // Delete files, least recently used first
+    std::sort(files.begin(), files.end());
+    for (auto &it : files) {
+        
+        if (total <= directoryCapacity) break;
+        
+        size_t size = (size_t)fs::file_size(it.second, ec);
+        if (fs::remove(it.second, ec)) total -= size;
+    }
+}
@@ -0,0 +1,166 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _DISK_CACHE_H
+#define _DISK_CACHE_H
+
+#include "AmigaObject.h"
+#include "FileTypes.h"
+#include <list>
+#include <unordered_map>
+
+/* A content-addressed cache for disk data that is expensive to recompute,
+ * e.g., unpacked DMS archives or converted directories. Entries are keyed by
+ * FNV fingerprints of the source data. If the capacity is exceeded, the
+ * least recently used entries are evicted. If a directory is assigned,
+ * entries are also written to disk which makes them survive an application
+ * restart. Each file carries a header with the key, the data size, and a
+ * checksum. Files failing the check are deleted. If the directory grows
+ * beyond its capacity, the least recently used files are deleted. The cache
+ * is shared by all emulator instances.
+ */
+class DiskCache : public AmigaObject {
+    
+    // Header of a persistent cache file
+    struct FileHeader {
+        
+        u32 magic;
+        u32 version;
+        u64 key;
+        u64 size;
+        u64 checksum;
+    };
+    
+    static const u32 fileMagic = 0x56414443; // 'VADC'
+    static const u32 fileVersion = 1;
+    
+    struct Entry {
+        
+        u8 *data;
+        size_t size;
+        std::list<u64>::iterator lru;
+    };
+    
+    // The cached data
+    std::unordered_map<u64, Entry> entries;
+    
+    // Keys of all cached entries, most recently used first
+    std::list<u64> lru;
+    
+    // Maximum amount of memory occupied by cached data
+    size_t capacity = 64 * 1024 * 1024;
+    
+    // Amount of memory currently occupied by cached data
+    size_t used = 0;
+    
+    // Location of the persistent cache (NULL if persistence is disabled)
+    char *directory = nullptr;
+    
+    // Maximum amount of disk space occupied by the persistent cache
+    size_t directoryCapacity = 256 * 1024 * 1024;
+    
+    // Collected statistical information
+    DiskCacheStats stats;
+    
+    
+    //
+    // Initializing
+    //
+    
+public:
+    
+    // Returns the cache instance shared by all emulator instances
+    static DiskCache &shared();
+
+    DiskCache();
+    ~DiskCache();
+    
+    
+    //
+    // Computing keys
+    //
+    
+public:
+    
+    // Entry categories
+    enum { KEY_DMS = 1, KEY_DIR };
+    
+    // Derives a cache key from a fingerprint and additional parameters
+    static u64 makeKey(u64 fnv, u64 category, u64 param1 = 0, u64 param2 = 0);
+    
+    
+    //
+    // Configuring
+    //
+    
+public:
+    
+    size_t getCapacity() { return capacity; }
+    void setCapacity(size_t bytes);
+    
+    const char *getDirectory() { return directory ? directory : ""; }
+    void setDirectory(const char *path);
+    
+    size_t getDirectoryCapacity() { return directoryCapacity; }
+    void setDirectoryCapacity(size_t bytes);
+    
+    // Returns statistical information about the cache
+    DiskCacheStats getStats();
+    
+    // Removes all entries from memory (the persistent cache is kept)
+    void clear();
+    
+    
+    //
+    // Accessing
+    //
+    
+public:
+    
+    /* Returns the size of a cached entry or 0 if the key is unknown. If the
+     * entry is not in memory, it is loaded from the persistent cache. A
+     * failed query is counted as a miss.
+     */
+    size_t sizeOf(u64 key);
+    
+    /* Copies a cached entry into the provided buffer. The function fails
+     * if the key is unknown or the entry has a different size.
+     */
+    bool lookup(u64 key, u8 *buffer, size_t size);
+    
+    /* Adds an entry to the cache. The entry is also written to the cache
+     * directory if one has been assigned.
+     */
+    void store(u64 key, const u8 *buffer, size_t size);
+    
+private:
+    
+    // Returns an entry and marks it as recently used (NULL if not in memory)
+    Entry *find(u64 key);
+    
+    // Adds an entry to the memory cache (takes ownership of the buffer)
+    void insert(u64 key, u8 *buffer, size_t size);
+    
+    // Evicts entries until the cache fits into its capacity limit
+    void shrink();
+    
+    // Assembles the path of a persistent cache entry
+    char *pathOf(u64 key);
+    
+    // Writes a cache entry to the persistent cache
+    bool save(u64 key, const u8 *buffer, size_t size);
+    
+    // Reads a persistent cache entry into memory
+    bool load(u64 key);
+    
+    // Deletes files until the persistent cache fits into its capacity limit
+    void trimDirectory();
+};
+
+#endif
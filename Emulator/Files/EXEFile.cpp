@@ -72,9 +72,9 @@ EXEFile::readFromBuffer(const u8 *buffer, size_t length)
     if (!isEXEBuffer(buffer, length))
         return false;
     
-    if (!AmigaFile::readFromBuffer(buffer, length))
-        return false;
-        
+    // The executable is read in place and not copied, since only the ADF is
+    // kept.
+    
     // Check if this file requires an HD disk
     bool hd = length > 853000;
     
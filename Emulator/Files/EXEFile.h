@@ -47,6 +47,7 @@ public:
     AmigaFileType fileType() override { return FILETYPE_EXE; }
     const char *typeAsString() override { return "EXE"; }
     u64 fnv() override { return adf->fnv(); }
+    size_t writeToBuffer(u8 *buffer) override { return adf->writeToBuffer(buffer); }
     bool bufferHasSameType(const u8 *buffer, size_t length) override {
         return isEXEBuffer(buffer, length); }
     bool fileHasSameType(const char *path) override { return isEXEFile(path); }
@@ -87,4 +87,24 @@ typedef VA_ENUM(long, DecryptionError)
     DECRYPT_INVALID_ROM_KEY_FILE
 };
 
+typedef struct
+{
+    // Lookups served by the disk cache
+    long hits;
+
+    // Lookups that had to compute the requested data
+    long misses;
+
+    // Entries removed to stay within the capacity limit
+    long evictions;
+
+    // Persistent entries discarded due to a failed integrity check
+    long rejected;
+
+    // Number of cached entries and the memory they occupy
+    long entries;
+    long bytes;
+}
+DiskCacheStats;
+
 #endif
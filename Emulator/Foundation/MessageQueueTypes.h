@@ -80,6 +80,7 @@ typedef VA_ENUM(long, MessageType)
     // Screen recording
     MSG_RECORDING_STARTED,
     MSG_RECORDING_STOPPED,
+    MSG_RECORDING_ABORTED,
     
     // Debugging
     MSG_DMA_DEBUG_ON,
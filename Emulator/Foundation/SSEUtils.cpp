@@ -43,6 +43,423 @@ void transposeSSE(u16 *source, u8* target)
     _mm_store_si128((__m128i *)target, shuffled);
 }
 
+__attribute__((target("avx2")))
+void transposeAVX2(u16 *source, u8* target)
+{
+    // Lane i selects the bit of column i (the MSB belongs to column 0)
+    const __m256i bits = _mm256_setr_epi16(0x8000, 0x4000, 0x2000, 0x1000,
+                                           0x0800, 0x0400, 0x0200, 0x0100,
+                                           0x0080, 0x0040, 0x0020, 0x0010,
+                                           0x0008, 0x0004, 0x0002, 0x0001);
+    __m256i columns = _mm256_setzero_si256();
+
+    // Distribute the bits of each row among all 16 columns
+    for (unsigned i = 0; i < 8; i++) {
+
+        __m256i row = _mm256_set1_epi16(source[i]);
+        __m256i set = _mm256_cmpeq_epi16(_mm256_and_si256(row, bits), bits);
+        columns = _mm256_or_si256(columns,
+                                  _mm256_and_si256(set, _mm256_set1_epi16(1 << i)));
+    }
+
+    // Pack the 16-bit column values into bytes
+    __m128i lo = _mm256_castsi256_si128(columns);
+    __m128i hi = _mm256_extracti128_si256(columns, 1);
+    _mm_store_si128((__m128i *)target, _mm_packus_epi16(lo, hi));
+}
+
+bool hasAVX2()
+{
+    static bool result = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return result;
+}
+
+bool hasBMI2()
+{
+    static bool result = (__builtin_cpu_init(), __builtin_cpu_supports("bmi2"));
+    return result;
+}
+
+void transpose(u16 *source, u8* target)
+{
+    static void (*func)(u16 *, u8 *) = hasAVX2() ? transposeAVX2 : transposeSSE;
+    func(source, target);
+}
+
+void mergeSSE(u8 *source, u8 *target, u8 keep, u8 mask, bool lores)
+{
+    __m128i vkeep = _mm_set1_epi8(keep);
+    __m128i vmask = _mm_set1_epi8(mask);
+    __m128i pixels = _mm_and_si128(_mm_load_si128((__m128i *)source), vmask);
+
+    if (lores) {
+
+        // Duplicate each pixel
+        __m128i lo = _mm_unpacklo_epi8(pixels, pixels);
+        __m128i hi = _mm_unpackhi_epi8(pixels, pixels);
+
+        __m128i old1 = _mm_loadu_si128((__m128i *)target);
+        __m128i old2 = _mm_loadu_si128((__m128i *)(target + 16));
+        _mm_storeu_si128((__m128i *)target,
+                         _mm_or_si128(_mm_and_si128(old1, vkeep), lo));
+        _mm_storeu_si128((__m128i *)(target + 16),
+                         _mm_or_si128(_mm_and_si128(old2, vkeep), hi));
+
+    } else {
+
+        __m128i old = _mm_loadu_si128((__m128i *)target);
+        _mm_storeu_si128((__m128i *)target,
+                         _mm_or_si128(_mm_and_si128(old, vkeep), pixels));
+    }
+}
+
+__attribute__((target("avx2")))
+void colorizeAVX2(u8 *source, u32 *target, u32 *table, int count)
+{
+    int i = 0;
+
+    // Translate eight pixels at once
+    for (; i + 8 <= count; i += 8) {
+
+        __m128i bytes = _mm_loadl_epi64((__m128i *)(source + i));
+        __m256i index = _mm256_cvtepu8_epi32(bytes);
+        __m256i color = _mm256_i32gather_epi32((const int *)table, index, 4);
+        _mm256_storeu_si256((__m256i *)(target + i), color);
+    }
+
+    // Translate the remaining pixels
+    for (; i < count; i++) target[i] = table[source[i]];
+}
+
+__attribute__((target("avx2")))
+void colorizeHAMAVX2(u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                     u16 *colreg, u32 *rgba, u32 *spriteRgba, u16 spMask,
+                     u32 *target, int count, u16 &ham)
+{
+    // Write masks for the four HAM control codes (set, blue, red, green)
+    const __m256i modMask = _mm256_setr_epi32(0xFFF, 0x00F, 0xF00, 0x0F0, 0, 0, 0, 0);
+
+    // Shift amounts for placing the data bits (set, blue, red, green)
+    const __m256i modShift = _mm256_setr_epi32(0, 0, 8, 4, 0, 0, 0, 0);
+
+    // Permutations for shifting lanes by 1, 2, and 4 positions
+    const __m256i shift1 = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m256i shift2 = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5);
+    const __m256i shift4 = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3);
+
+    const __m256i zSprite = _mm256_set1_epi32(spMask);
+    const __m256i zOther = _mm256_set1_epi32(~spMask & 0xFFFF);
+
+    // Widen the color registers to make them accessible by gather instructions
+    u32 regs[32];
+    for (int j = 0; j < 32; j++) regs[j] = colreg[j];
+
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+
+        __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)(bbuf + i)));
+        __m256i d = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)(ibuf + i)));
+        __m256i c = _mm256_and_si256(_mm256_srli_epi32(b, 4), _mm256_set1_epi32(3));
+
+        // Determine which bits are written by each pixel and their values
+        __m256i m = _mm256_permutevar8x32_epi32(modMask, c);
+        __m256i s = _mm256_permutevar8x32_epi32(modShift, c);
+        __m256i nib = _mm256_sllv_epi32(_mm256_and_si256(d, _mm256_set1_epi32(0xF)), s);
+        __m256i reg = _mm256_i32gather_epi32((const int *)regs,
+                                             _mm256_and_si256(d, _mm256_set1_epi32(0x1F)), 4);
+        __m256i isSet = _mm256_cmpeq_epi32(c, _mm256_setzero_si256());
+        __m256i v = _mm256_blendv_epi8(nib, reg, isSet);
+
+        /* Combine the modifications with a prefix scan. Combining (m1, v1)
+         * with a subsequent (m2, v2) yields (m1 | m2, (v1 & ~m2) | v2).
+         */
+        __m256i pm, pv;
+        pm = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(m, shift1), _mm256_setzero_si256(), 0x01);
+        pv = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, shift1), _mm256_setzero_si256(), 0x01);
+        v = _mm256_or_si256(_mm256_andnot_si256(m, pv), v);
+        m = _mm256_or_si256(m, pm);
+        pm = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(m, shift2), _mm256_setzero_si256(), 0x03);
+        pv = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, shift2), _mm256_setzero_si256(), 0x03);
+        v = _mm256_or_si256(_mm256_andnot_si256(m, pv), v);
+        m = _mm256_or_si256(m, pm);
+        pm = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(m, shift4), _mm256_setzero_si256(), 0x0F);
+        pv = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, shift4), _mm256_setzero_si256(), 0x0F);
+        v = _mm256_or_si256(_mm256_andnot_si256(m, pv), v);
+        m = _mm256_or_si256(m, pm);
+
+        // Apply the modifications to the hold register
+        __m256i hold = _mm256_or_si256(_mm256_andnot_si256(m, _mm256_set1_epi32(ham)), v);
+        ham = (u16)_mm256_extract_epi32(hold, 7);
+
+        // Translate into RGBA values
+        __m256i color = _mm256_i32gather_epi32((const int *)rgba, hold, 4);
+
+        // Let visible sprite pixels shine through
+        __m256i z = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i *)(zbuf + i)));
+        __m256i visible = _mm256_cmpgt_epi32(_mm256_and_si256(z, zSprite),
+                                             _mm256_and_si256(z, zOther));
+        if (!_mm256_testz_si256(visible, visible)) {
+            __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)(mbuf + i)));
+            __m256i sprite = _mm256_i32gather_epi32((const int *)spriteRgba, index, 4);
+            color = _mm256_blendv_epi8(color, sprite, visible);
+        }
+
+        _mm256_storeu_si256((__m256i *)(target + i), color);
+    }
+
+    // Synthesize the remaining pixels
+    for (; i < count; i++) {
+
+        u8 index = ibuf[i];
+
+        switch ((bbuf[i] >> 4) & 0b11) {
+
+            case 0b00: ham = colreg[index & 0x1F]; break;
+            case 0b01: ham = (ham & 0xFF0) | (index & 0b1111); break;
+            case 0b10: ham = (ham & 0x0FF) | (index & 0b1111) << 8; break;
+            case 0b11: ham = (ham & 0xF0F) | (index & 0b1111) << 4; break;
+        }
+
+        u16 z = zbuf[i];
+        bool visible = (z & spMask) > (z & ~spMask);
+        target[i] = visible ? spriteRgba[mbuf[i]] : rgba[ham];
+    }
+}
+
+void rgbaToYUVSSE(u8 *row0, u8 *row1, u8 *y0, u8 *y1, u8 *u, u8 *v,
+                  int width, bool interleaved)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i cy = _mm_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0);
+    const __m128i cu = _mm_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0);
+    const __m128i cv = _mm_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0);
+    const __m128i yrnd = _mm_set1_epi32(128);
+    const __m128i crnd = _mm_set1_epi32(512);
+    const __m128i yoff = _mm_set1_epi32(16);
+    const __m128i coff = _mm_set1_epi32(128);
+    const __m128i nv12 = _mm_setr_epi8(0, 2, 1, 3, -1, -1, -1, -1,
+                                       -1, -1, -1, -1, -1, -1, -1, -1);
+    int i = 0;
+
+    // Convert two 4 x 1 pixel blocks at once
+    for (; i + 4 <= width; i += 4) {
+
+        __m128i p0 = _mm_loadu_si128((__m128i *)(row0 + 4 * i));
+        __m128i p1 = _mm_loadu_si128((__m128i *)(row1 + 4 * i));
+
+        // Expand the color components to 16 bit
+        __m128i a0 = _mm_unpacklo_epi8(p0, zero);
+        __m128i a1 = _mm_unpackhi_epi8(p0, zero);
+        __m128i b0 = _mm_unpacklo_epi8(p1, zero);
+        __m128i b1 = _mm_unpackhi_epi8(p1, zero);
+
+        // Compute luma
+        __m128i l0 = _mm_hadd_epi32(_mm_madd_epi16(a0, cy), _mm_madd_epi16(a1, cy));
+        __m128i l1 = _mm_hadd_epi32(_mm_madd_epi16(b0, cy), _mm_madd_epi16(b1, cy));
+        l0 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(l0, yrnd), 8), yoff);
+        l1 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(l1, yrnd), 8), yoff);
+        __m128i luma = _mm_packus_epi16(_mm_packs_epi32(l0, l1), zero);
+
+        *(u32 *)(y0 + i) = (u32)_mm_cvtsi128_si32(luma);
+        *(u32 *)(y1 + i) = (u32)_mm_cvtsi128_si32(_mm_srli_si128(luma, 4));
+
+        // Sum up the color components of both 2 x 2 blocks
+        __m128i s0 = _mm_add_epi16(a0, b0);
+        __m128i s1 = _mm_add_epi16(a1, b1);
+        s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+        s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+        __m128i s = _mm_unpacklo_epi64(s0, s1);
+
+        // Compute chroma (U0, U1, V0, V1)
+        __m128i c = _mm_hadd_epi32(_mm_madd_epi16(s, cu), _mm_madd_epi16(s, cv));
+        c = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(c, crnd), 10), coff);
+        __m128i chroma = _mm_packus_epi16(_mm_packs_epi32(c, zero), zero);
+
+        if (interleaved) {
+            chroma = _mm_shuffle_epi8(chroma, nv12);
+            *(u32 *)(u + i) = (u32)_mm_cvtsi128_si32(chroma);
+        } else {
+            u32 uv = (u32)_mm_cvtsi128_si32(chroma);
+            *(u16 *)(u + i / 2) = (u16)uv;
+            *(u16 *)(v + i / 2) = (u16)(uv >> 16);
+        }
+    }
+
+    // Convert the remaining 2 x 2 block (if any)
+    for (; i < width; i += 2) {
+
+        int r = 0, g = 0, b = 0;
+        for (int j = 0; j < 2; j++) {
+
+            u8 *q0 = row0 + 4 * (i + j);
+            u8 *q1 = row1 + 4 * (i + j);
+            y0[i + j] = (u8)(((66 * q0[0] + 129 * q0[1] + 25 * q0[2] + 128) >> 8) + 16);
+            y1[i + j] = (u8)(((66 * q1[0] + 129 * q1[1] + 25 * q1[2] + 128) >> 8) + 16);
+            r += q0[0] + q1[0];
+            g += q0[1] + q1[1];
+            b += q0[2] + q1[2];
+        }
+        u8 cb = (u8)(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+        u8 cr = (u8)(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+
+        if (interleaved) {
+            u[i] = cb;
+            u[i + 1] = cr;
+        } else {
+            u[i / 2] = cb;
+            v[i / 2] = cr;
+        }
+    }
+}
+
+void mixSSE(float **ch, float *gainL, float *gainR,
+            float *left, float *right, int count)
+{
+    __m128 gl[4], gr[4];
+    for (int k = 0; k < 4; k++) {
+        gl[k] = _mm_set1_ps(gainL[k]);
+        gr[k] = _mm_set1_ps(gainR[k]);
+    }
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        __m128 s0 = _mm_loadu_ps(ch[0] + i);
+        __m128 s1 = _mm_loadu_ps(ch[1] + i);
+        __m128 s2 = _mm_loadu_ps(ch[2] + i);
+        __m128 s3 = _mm_loadu_ps(ch[3] + i);
+
+        // Apply the gain vectors
+        __m128 l = _mm_mul_ps(s0, gl[0]);
+        __m128 r = _mm_mul_ps(s0, gr[0]);
+        l = _mm_add_ps(l, _mm_mul_ps(s1, gl[1]));
+        r = _mm_add_ps(r, _mm_mul_ps(s1, gr[1]));
+        l = _mm_add_ps(l, _mm_mul_ps(s2, gl[2]));
+        r = _mm_add_ps(r, _mm_mul_ps(s2, gr[2]));
+        l = _mm_add_ps(l, _mm_mul_ps(s3, gl[3]));
+        r = _mm_add_ps(r, _mm_mul_ps(s3, gr[3]));
+
+        _mm_storeu_ps(left + i, l);
+        _mm_storeu_ps(right + i, r);
+    }
+
+    // Process the remaining samples one by one
+    for (; i < count; i++) {
+
+        float s0 = ch[0][i], s1 = ch[1][i], s2 = ch[2][i], s3 = ch[3][i];
+
+        left[i] =
+        s0 * gainL[0] + s1 * gainL[1] + s2 * gainL[2] + s3 * gainL[3];
+
+        right[i] =
+        s0 * gainR[0] + s1 * gainR[1] + s2 * gainR[2] + s3 * gainR[3];
+    }
+}
+
+void blepSSE(float *target, const float *row0, const float *row1,
+             float weight, float delta, int count)
+{
+    assert(count % 4 == 0);
+
+    __m128 w = _mm_set1_ps(weight);
+    __m128 d = _mm_set1_ps(delta);
+
+    for (int i = 0; i < count; i += 4) {
+
+        __m128 r0 = _mm_loadu_ps(row0 + i);
+        __m128 r1 = _mm_loadu_ps(row1 + i);
+        __m128 r = _mm_add_ps(r0, _mm_mul_ps(w, _mm_sub_ps(r1, r0)));
+        __m128 t = _mm_loadu_ps(target + i);
+        _mm_storeu_ps(target + i, _mm_add_ps(t, _mm_mul_ps(d, r)));
+    }
+}
+
+void biquadSSE(float *l, float *r, int count, double *coeff, double *state)
+{
+    __m128d b0 = _mm_set1_pd(coeff[0]);
+    __m128d b1 = _mm_set1_pd(coeff[1]);
+    __m128d b2 = _mm_set1_pd(coeff[2]);
+    __m128d a1 = _mm_set1_pd(coeff[3]);
+    __m128d a2 = _mm_set1_pd(coeff[4]);
+
+    __m128d x1 = _mm_loadu_pd(state);
+    __m128d x2 = _mm_loadu_pd(state + 2);
+    __m128d y1 = _mm_loadu_pd(state + 4);
+    __m128d y2 = _mm_loadu_pd(state + 6);
+
+    for (int i = 0; i < count; i++) {
+
+        // Run pipeline
+        __m128d x0 = _mm_set_pd((double)r[i], (double)l[i]);
+        __m128d y0 = _mm_mul_pd(b0, x0);
+        y0 = _mm_add_pd(y0, _mm_mul_pd(b1, x1));
+        y0 = _mm_add_pd(y0, _mm_mul_pd(b2, x2));
+        y0 = _mm_add_pd(y0, _mm_mul_pd(a1, y1));
+        y0 = _mm_add_pd(y0, _mm_mul_pd(a2, y2));
+
+        // Shift pipeline
+        x2 = x1; x1 = x0;
+        y2 = y1; y1 = y0;
+
+        __m128 out = _mm_cvtpd_ps(y0);
+        _mm_store_ss(l + i, out);
+        _mm_store_ss(r + i, _mm_shuffle_ps(out, out, 1));
+    }
+
+    _mm_storeu_pd(state, x1);
+    _mm_storeu_pd(state + 2, x2);
+    _mm_storeu_pd(state + 4, y1);
+    _mm_storeu_pd(state + 6, y2);
+}
+
+__attribute__((target("bmi2")))
+void encodeMFMBMI2(u8 *dst, u8 *src, size_t count)
+{
+    size_t i = 0;
+
+    // Expand four bytes into four MFM words at once
+    for (; i + 4 <= count; i += 4) {
+
+        u32 data;
+        memcpy(&data, src + i, 4);
+        u64 mfm = _pdep_u64(__builtin_bswap32(data), 0x5555555555555555);
+        mfm = __builtin_bswap64(mfm);
+        memcpy(dst + 2 * i, &mfm, 8);
+    }
+
+    // Process the remaining bytes
+    for (; i < count; i++) {
+
+        u16 mfm = (u16)_pdep_u32(src[i], 0x5555);
+        dst[2 * i + 0] = HI_BYTE(mfm);
+        dst[2 * i + 1] = LO_BYTE(mfm);
+    }
+}
+
+__attribute__((target("bmi2")))
+void decodeMFMBMI2(u8 *dst, u8 *src, size_t count)
+{
+    size_t i = 0;
+
+    // Compress four MFM words into four bytes at once
+    for (; i + 4 <= count; i += 4) {
+
+        u64 mfm;
+        memcpy(&mfm, src + 2 * i, 8);
+        u32 data = (u32)_pext_u64(__builtin_bswap64(mfm), 0x5555555555555555);
+        data = __builtin_bswap32(data);
+        memcpy(dst + i, &data, 4);
+    }
+
+    // Process the remaining bytes
+    for (; i < count; i++) {
+
+        u16 mfm = HI_LO(src[2 * i], src[2 * i + 1]);
+        dst[i] = (u8)_pext_u32(mfm, 0x5555);
+    }
+}
+
 #else
 
 void transposeSSE(u16 *source, u8* target)
@@ -50,4 +467,74 @@ void transposeSSE(u16 *source, u8* target)
     assert(false);
 }
 
+void transposeAVX2(u16 *source, u8* target)
+{
+    assert(false);
+}
+
+bool hasAVX2()
+{
+    return false;
+}
+
+bool hasBMI2()
+{
+    return false;
+}
+
+void transpose(u16 *source, u8* target)
+{
+    assert(false);
+}
+
+void mergeSSE(u8 *source, u8 *target, u8 keep, u8 mask, bool lores)
+{
+    assert(false);
+}
+
+void colorizeAVX2(u8 *source, u32 *target, u32 *table, int count)
+{
+    assert(false);
+}
+
+void colorizeHAMAVX2(u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                     u16 *colreg, u32 *rgba, u32 *spriteRgba, u16 spMask,
+                     u32 *target, int count, u16 &ham)
+{
+    assert(false);
+}
+
+void rgbaToYUVSSE(u8 *row0, u8 *row1, u8 *y0, u8 *y1, u8 *u, u8 *v,
+                  int width, bool interleaved)
+{
+    assert(false);
+}
+
+void mixSSE(float **ch, float *gainL, float *gainR,
+            float *left, float *right, int count)
+{
+    assert(false);
+}
+
+void blepSSE(float *target, const float *row0, const float *row1,
+             float weight, float delta, int count)
+{
+    assert(false);
+}
+
+void biquadSSE(float *l, float *r, int count, double *coeff, double *state)
+{
+    assert(false);
+}
+
+void encodeMFMBMI2(u8 *dst, u8 *src, size_t count)
+{
+    assert(false);
+}
+
+void decodeMFMBMI2(u8 *dst, u8 *src, size_t count)
+{
+    assert(false);
+}
+
 #endif
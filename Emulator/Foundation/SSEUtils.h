@@ -34,4 +34,98 @@
  */
 void transposeSSE(u16 *source, u8* target);
 
+/* Transposes a 8 x 16 bit matrix using AVX2 extensions. The function has the
+ * same semantics as transposeSSE(). It must only be called if the host CPU
+ * supports AVX2 (see hasAVX2()).
+ */
+void transposeAVX2(u16 *source, u8* target);
+
+/* Transposes a 8 x 16 bit matrix with the fastest implementation supported by
+ * the host CPU. The implementation is selected once at runtime via CPUID.
+ */
+void transpose(u16 *source, u8* target);
+
+// Checks if the host CPU supports AVX2 extensions
+bool hasAVX2();
+
+// Checks if the host CPU supports BMI2 extensions
+bool hasBMI2();
+
+/* Merges 16 pixels into a pixel buffer using SSE2 extensions. Each target
+ * pixel is computed as (target & keep) | (source & mask). In lores mode, each
+ * source pixel is written twice which means that 32 target bytes are written.
+ *
+ *     Input:   A pointer to a u8[16] array as computed by transpose().
+ *     Output:  A pointer into the pixel buffer (no alignment required).
+ */
+void mergeSSE(u8 *source, u8 *target, u8 keep, u8 mask, bool lores);
+
+/* Translates color indices into RGBA values using AVX2 gather instructions.
+ * The function computes target[i] = table[source[i]] for all i < count. It
+ * must only be called if the host CPU supports AVX2 (see hasAVX2()).
+ */
+void colorizeAVX2(u8 *source, u32 *target, u32 *table, int count);
+
+/* Synthesizes HAM pixels using AVX2 extensions. For each pixel, the control
+ * bits are taken from bits 4 and 5 of bbuf and the data bits from ibuf. The
+ * hold-and-modify chain is resolved with a parallel prefix computation.
+ * Pixels with a visible sprite (as indicated by the depth values in zbuf) are
+ * taken from spriteRgba[mbuf[i]]. The hold register is read on entry and
+ * updated on exit.
+ *
+ *     colreg : The 12-bit values of the 32 color registers
+ *       rgba : RGBA values of all 4096 Amiga colors
+ *     spMask : Depth buffer bits indicating sprite pixels
+ */
+void colorizeHAMAVX2(u8 *bbuf, u8 *ibuf, u8 *mbuf, u16 *zbuf,
+                     u16 *colreg, u32 *rgba, u32 *spriteRgba, u16 spMask,
+                     u32 *target, int count, u16 &ham);
+
+/* Converts two rows of RGBA pixels to YUV 4:2:0 using SSSE3 extensions. The
+ * conversion follows ITU-R BT.601 with limited range. A luma value is written
+ * for each pixel and a single chroma pair for each 2 x 2 block. In interleaved
+ * mode (NV12), the chroma values are written alternately to u and v is unused.
+ * The width must be even.
+ */
+void rgbaToYUVSSE(u8 *row0, u8 *row1, u8 *y0, u8 *y1, u8 *u, u8 *v,
+                  int width, bool interleaved);
+
+/* Mixes four audio channels into a stereo signal using SSE extensions. For
+ * each sample, the left output is computed as the sum of ch[k][i] * gainL[k]
+ * and the right output as the sum of ch[k][i] * gainR[k].
+ */
+void mixSSE(float **ch, float *gainL, float *gainR,
+            float *left, float *right, int count);
+
+/* Adds a scaled filter response to a buffer using SSE extensions. The response
+ * is interpolated between two rows of a polyphase table:
+ *
+ *     target[i] += delta * (row0[i] + weight * (row1[i] - row0[i]))
+ *
+ * The count must be a multiple of 4.
+ */
+void blepSSE(float *target, const float *row0, const float *row1,
+             float weight, float delta, int count);
+
+/* Runs a block of stereo samples through a biquad filter using SSE2
+ * extensions. Both channels are processed in parallel in the two lanes of a
+ * double precision vector.
+ *
+ *     coeff : Filter coefficients (b0, b1, b2, a1, a2)
+ *     state : Filter pipeline (x1, x2, y1, y2 for both channels, interleaved)
+ */
+void biquadSSE(float *l, float *r, int count, double *coeff, double *state);
+
+/* MFM encodes a byte stream using the BMI2 instruction pdep. Each source byte
+ * is expanded to a big endian MFM word with the data bits placed at the even
+ * bit positions. Clock bits are not added. The function must only be called
+ * if the host CPU supports BMI2 (see hasBMI2()).
+ */
+void encodeMFMBMI2(u8 *dst, u8 *src, size_t count);
+
+/* Decodes a MFM stream using the BMI2 instruction pext. This is the inverse
+ * function of encodeMFMBMI2(). The clock bits are ignored.
+ */
+void decodeMFMBMI2(u8 *dst, u8 *src, size_t count);
+
 #endif
@@ -177,14 +177,14 @@ matchingFileHeader(const char *path, const u8 *header, size_t length)
     if ((file = fopen(path, "r")) == nullptr)
         return false;
     
-    for (unsigned i = 0; i < length; i++) {
-        int c = fgetc(file);
-        if (c != (int)header[i]) {
-            result = false;
-            break;
-        }
+    u8 *buffer = new u8[length];
+    if (fread(buffer, 1, length, file) != length) {
+        result = false;
+    } else {
+        result = matchingBufferHeader(buffer, header, length);
     }
     
+    delete[] buffer;
     fclose(file);
     return result;
 }
@@ -226,10 +226,10 @@ loadFile(const char *path, u8 **buffer, long *size)
     if (data == nullptr) { fclose(file); return false; }
     
     // Read data
-    for (unsigned i = 0; i < bytes; i++) {
-        int c = fgetc(file);
-        if (c == EOF) break;
-        data[i] = (u8)c;
+    if (fread(data, 1, bytes, file) != (size_t)bytes) {
+        delete[] data;
+        fclose(file);
+        return false;
     }
     
     fclose(file);
@@ -252,6 +252,80 @@ loadFile(const char *path, const char *name, u8 **buffer, long *size)
     return loadFile(fullpath, buffer, size);
 }
 
+bool
+mapFile(FILE *file, const u8 **buffer, size_t *size, bool *mapped)
+{
+    assert(file != nullptr);
+    assert(buffer != nullptr);
+    assert(size != nullptr);
+    assert(mapped != nullptr);
+    
+    struct stat fileProperties;
+    int fd = fileno(file);
+    
+    *buffer = nullptr;
+    *size = 0;
+    *mapped = false;
+    
+    // Try to map the file if it is a regular, non-empty file
+    if (fd >= 0 && fstat(fd, &fileProperties) == 0 &&
+        S_ISREG(fileProperties.st_mode) && fileProperties.st_size > 0) {
+        
+        size_t bytes = (size_t)fileProperties.st_size;
+        void *addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        
+        if (addr != MAP_FAILED) {
+            *buffer = (const u8 *)addr;
+            *size = bytes;
+            *mapped = true;
+            return true;
+        }
+    }
+    
+    // Fall back to a single bulk read
+    if (fseek(file, 0, SEEK_END) != 0) return false;
+    long bytes = ftell(file);
+    if (bytes < 0) return false;
+    rewind(file);
+    
+    u8 *data = new u8[bytes];
+    if (fread(data, 1, bytes, file) != (size_t)bytes) {
+        delete[] data;
+        return false;
+    }
+    
+    *buffer = data;
+    *size = (size_t)bytes;
+    return true;
+}
+
+bool
+mapFile(const char *path, const u8 **buffer, size_t *size, bool *mapped)
+{
+    assert(path != nullptr);
+    
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) return false;
+    
+    // A mapping stays valid after the file has been closed
+    bool result = mapFile(file, buffer, size, mapped);
+    fclose(file);
+    
+    return result;
+}
+
+void
+unmapFile(const u8 *buffer, size_t size, bool mapped)
+{
+    if (buffer == nullptr) return;
+    
+    if (mapped) {
+        munmap((void *)buffer, size);
+    } else {
+        delete[] buffer;
+    }
+}
+
 void
 sleepMicrosec(unsigned usec)
 {
@@ -260,6 +334,15 @@ sleepMicrosec(unsigned usec)
     }
 }
 
+u64
+nanos()
+{
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+
+    return mach_absolute_time() * tb.numer / tb.denom;
+}
+
 i64
 sleepUntil(u64 kernelTargetTime, u64 kernelEarlyWakeup)
 {
@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -177,6 +178,14 @@ bool matchingBufferHeader(const u8 *buffer, const u8 *header, size_t length);
 bool loadFile(const char *path, u8 **buffer, long *size);
 bool loadFile(const char *path, const char *name, u8 **buffer, long *size);
 
+/* Maps a file into memory (read-only). If the file cannot be mapped, its
+ * contents are read into a heap buffer with a single bulk read. In both
+ * cases, the buffer must be handed back to unmapFile() when no longer needed.
+ */
+bool mapFile(const char *path, const u8 **buffer, size_t *size, bool *mapped);
+bool mapFile(FILE *file, const u8 **buffer, size_t *size, bool *mapped);
+void unmapFile(const u8 *buffer, size_t size, bool mapped);
+
 
 //
 // Controlling time
@@ -185,6 +194,9 @@ bool loadFile(const char *path, const char *name, u8 **buffer, long *size);
 // Puts the current thread to sleep for a given amout of micro seconds
 void sleepMicrosec(unsigned usec);
 
+// Returns the current kernel time converted to nanoseconds
+u64 nanos();
+
 /* Sleeps until the kernel timer reaches kernelTargetTime
  *
  * kernelEarlyWakeup: To increase timing precision, the function wakes up the
@@ -1615,6 +1615,21 @@ Memory::poke16 <AGNUS_ACCESS> (u32 addr, u16 value)
     }
 }
 
+u8 *
+Memory::chipBlock(u32 addr, size_t count)
+{
+    assert(count > 0);
+    
+    // The block must neither wrap around nor be mirrored
+    if (addr + count > config.chipSize) return NULL;
+    
+    for (u32 bank = addr >> 16; bank <= (addr + count - 1) >> 16; bank++) {
+        if (agnusMemSrc[bank] != MEM_CHIP) return NULL;
+    }
+
+    return chip + addr;
+}
+
 u8
 Memory::peekCIA8(u32 addr)
 {
@@ -431,6 +431,12 @@ public:
     template <Accessor acc> void poke8(u32 addr, u8 value);
     template <Accessor acc> void poke16(u32 addr, u16 value);
     
+    /* Returns a pointer to a block of Chip Ram that is overwritten in a
+     * single step or NULL if the block is not entirely visible to Agnus as
+     * Chip Ram.
+     */
+    u8 *chipBlock(u32 addr, size_t count);
+    
 
     //
     // Accessing the CIA space
@@ -8,12 +8,14 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "SSEUtils.h"
 
 AudioFilter::AudioFilter(Amiga& ref) : AmigaComponent(ref)
 {
     setDescription("AudioFilter");
 
-    a1 = a2 = b0 = b1 = b2 = 0.0;
+    for (int i = 0; i < 5; i++) coeff[i] = 0.0;
+    clear();
 }
 
 void
@@ -26,6 +28,10 @@ AudioFilter::setFilterType(FilterType type)
 void
 AudioFilter::setSampleRate(double sampleRate)
 {
+    // Only proceed if the coefficients need to be recomputed
+    if (sampleRate == rate) return;
+    rate = sampleRate;
+
     trace(AUD_DEBUG, "Setting sample rate to %f Hz\n", sampleRate);
     
     // Compute butterworth filter coefficients based on
@@ -42,34 +48,61 @@ AudioFilter::setSampleRate(double sampleRate)
     const double ita = 1.0/ tan(M_PI*ff);
     const double q = sqrt(2.0);
     
-    b0 = 1.0 / (1.0 + q * ita + ita * ita);
-    b1 = 2 * b0;
-    b2 = b0;
-    a1 = 2.0 * (ita * ita - 1.0) * b0;
-    a2 = -(1.0 - q * ita + ita * ita) * b0;
+    double b0 = 1.0 / (1.0 + q * ita + ita * ita);
+    coeff[0] = b0;
+    coeff[1] = 2 * b0;
+    coeff[2] = b0;
+    coeff[3] = 2.0 * (ita * ita - 1.0) * b0;
+    coeff[4] = -(1.0 - q * ita + ita * ita) * b0;
 }
 
 void
 AudioFilter::clear()
 {
-    x1 = x2 = y1 = y2 = 0.0;
+    for (int i = 0; i < 8; i++) state[i] = 0.0;
 }
 
-float
-AudioFilter::apply(float sample)
+void
+AudioFilter::apply(float *l, float *r, size_t n)
 {
-    if (type == FILT_NONE) return sample;
+    if (type == FILT_NONE) return;
     
     // Apply butterworth filter
     assert(type == FILT_BUTTERWORTH);
-    
-    // Run pipeline
-    double x0 = (double)sample;
-    double y0 = (b0 * x0) + (b1 * x1) + (b2 * x2) + (a1 * y1) + (a2 * y2);
-    
-    // Shift pipeline
-    x2 = x1; x1 = x0;
-    y2 = y1; y1 = y0;
-    
-    return (float)y0;
+
+    // On Intel machines, filter both channels at once
+    #if defined(__i386__) || defined(__x86_64__)
+
+    if (!NO_SSE) {
+        biquadSSE(l, r, (int)n, coeff, state);
+        return;
+    }
+
+    #endif
+
+    double b0 = coeff[0], b1 = coeff[1], b2 = coeff[2];
+    double a1 = coeff[3], a2 = coeff[4];
+
+    for (int c = 0; c < 2; c++) {
+
+        float *data = c ? r : l;
+        double x1 = state[c], x2 = state[2 + c];
+        double y1 = state[4 + c], y2 = state[6 + c];
+
+        for (size_t i = 0; i < n; i++) {
+
+            // Run pipeline
+            double x0 = (double)data[i];
+            double y0 = (b0 * x0) + (b1 * x1) + (b2 * x2) + (a1 * y1) + (a2 * y2);
+
+            // Shift pipeline
+            x2 = x1; x1 = x0;
+            y2 = y1; y1 = y0;
+
+            data[i] = (float)y0;
+        }
+
+        state[c] = x1; state[2 + c] = x2;
+        state[4 + c] = y1; state[6 + c] = y2;
+    }
 }
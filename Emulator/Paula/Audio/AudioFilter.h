@@ -17,11 +17,17 @@ class AudioFilter : public AmigaComponent {
     // The currently set filter type
     FilterType type = FILT_BUTTERWORTH;
     
-    // Coefficients of the butterworth filter
-    double a1, a2, b0, b1, b2;
+    // The sample rate the coefficients have been computed for
+    double rate = 0.0;
+
+    // Coefficients of the butterworth filter (b0, b1, b2, a1, a2)
+    double coeff[5];
     
-    // The butterworth filter pipeline
-    double x1, x2, y1, y2;
+    /* The butterworth filter pipeline. Both stereo channels are filtered
+     * together. The array contains x1, x2, y1, y2 for the left and the right
+     * channel in interleaved order.
+     */
+    double state[8];
     
     
     //
@@ -87,8 +93,8 @@ public:
     // Initializes the filter pipeline with zero elements
     void clear();
 
-    // Inserts a sample into the filter pipeline
-    float apply(float sample);
+    // Runs a block of stereo samples through the filter pipeline
+    void apply(float *l, float *r, size_t n);
 };
     
 #endif
@@ -43,6 +43,7 @@ public:
      */
     static u32 samplesAhead() { return 8 * 735; }
     void alignWritePtr() { align(samplesAhead()); }
+    void alignWritePtr(u32 offset) { align(offset); }
     
     
     //
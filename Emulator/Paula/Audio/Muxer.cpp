@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include "Amiga.h"
+#include "SSEUtils.h"
 
 Muxer::Muxer(Amiga& ref) : AmigaComponent(ref)
 {
@@ -15,11 +16,13 @@ Muxer::Muxer(Amiga& ref) : AmigaComponent(ref)
     
     subComponents = vector<HardwareComponent *> {
 
-        &filterL,
-        &filterR
+        &filter
     };
     
+    config.latency = 50;
+
     setSampleRate(44100);
+    updateGains();
 }
     
 void
@@ -29,6 +32,7 @@ Muxer::_reset(bool hard)
     
     stats.bufferUnderflows = 0;
     stats.bufferOverflows = 0;
+    stats.saturations = 0;
 
     sampler[0].clear();
     sampler[1].clear();
@@ -42,6 +46,14 @@ Muxer::_reset(bool hard)
     sampler[3].write( TaggedSample { 0, 0 } );
 }
 
+void
+Muxer::attach(Muxer &other)
+{
+    source = &other;
+
+    for (int i = 0; i < 4; i++) cursor[i] = other.sampler[i].r;
+}
+
 void
 Muxer::clear()
 {
@@ -49,11 +61,11 @@ Muxer::clear()
     
     // Wipe out the ringbuffer
     stream.clear(SamplePair {0, 0});
-    stream.alignWritePtr();
+    stream.alignWritePtr((u32)targetLevel());
+    rate.reset(targetLevel());
     
-    // Wipe out the filter buffers
-    filterL.clear();
-    filterR.clear();
+    // Wipe out the filter pipeline
+    filter.clear();
 }
 
 long
@@ -65,8 +77,7 @@ Muxer::getConfigItem(ConfigOption option)
             return config.samplingMethod;
             
         case OPT_FILTER_TYPE:
-            assert(filterL.getFilterType() == config.filterType);
-            assert(filterR.getFilterType() == config.filterType);
+            assert(filter.getFilterType() == config.filterType);
             return config.filterType;
                         
         case OPT_FILTER_ALWAYS_ON:
@@ -102,6 +113,9 @@ Muxer::getConfigItem(ConfigOption option)
         case OPT_AUDPAN3:
             return (long)(config.pan[3] * 100.0);
 
+        case OPT_AUDLATENCY:
+            return config.latency;
+
         default: assert(false);
     }
 }
@@ -155,6 +169,15 @@ Muxer::setConfigItem(ConfigOption option, long value)
                 return false;
             }
             break;
+
+        case OPT_AUDLATENCY:
+
+            if (value < 10 || value > 200) {
+                warn("Invalid latency: %d\n", value);
+                warn("       Valid values: 10 ... 200\n");
+                return false;
+            }
+            break;
             
         default:
             break;
@@ -178,8 +201,7 @@ Muxer::setConfigItem(ConfigOption option, long value)
             }
 
             config.filterType = (FilterType)value;
-            filterL.setFilterType((FilterType)value);
-            filterR.setFilterType((FilterType)value);
+            filter.setFilterType((FilterType)value);
             return true;
                         
         case OPT_FILTER_ALWAYS_ON:
@@ -208,40 +230,53 @@ Muxer::setConfigItem(ConfigOption option, long value)
         case OPT_AUDVOL0:
             
             config.vol[0] = log2((double)value / 100.0) * 0.0000025;
+            updateGains();
             return true;
             
         case OPT_AUDVOL1:
             
             config.vol[1] = log2((double)value / 100.0) * 0.0000025;
+            updateGains();
             return true;
 
         case OPT_AUDVOL2:
             
             config.vol[2] = log2((double)value / 100.0) * 0.0000025;
+            updateGains();
             return true;
 
         case OPT_AUDVOL3:
             
             config.vol[3] = log2((double)value / 100.0) * 0.0000025;
+            updateGains();
             return true;
 
         case OPT_AUDPAN0:
             
             config.pan[0] = MAX(0.0, MIN(value / 100.0, 1.0));
+            updateGains();
             return true;
 
         case OPT_AUDPAN1:
             config.pan[1] = MAX(0.0, MIN(value / 100.0, 1.0));
+            updateGains();
             return true;
 
         case OPT_AUDPAN2:
             
             config.pan[2] = MAX(0.0, MIN(value / 100.0, 1.0));
+            updateGains();
             return true;
 
         case OPT_AUDPAN3:
             
             config.pan[3] = MAX(0.0, MIN(value / 100.0, 1.0));
+            updateGains();
+            return true;
+
+        case OPT_AUDLATENCY:
+
+            config.latency = value;
             return true;
 
         default:
@@ -260,6 +295,16 @@ Muxer::_dumpConfig()
     msg("    vol2, pan2 : %f, %f\n", config.vol[2], config.pan[2]);
     msg("    vol3, pan3 : %f, %f\n", config.vol[3], config.pan[3]);
     msg("    volL, volR : %f, %f\n", config.volL, config.volR);
+    msg("       latency : %d msec\n", config.latency);
+}
+
+void
+Muxer::updateGains()
+{
+    for (int i = 0; i < 4; i++) {
+        gainL[i] = (float)(config.vol[i] * config.pan[i]);
+        gainR[i] = (float)(config.vol[i] * (1 - config.pan[i]));
+    }
 }
 
 void
@@ -270,8 +315,7 @@ Muxer::setSampleRate(double hz)
     sampleRate = hz;
     cyclesPerSample = MHz(masterClockFrequency) / hz;
 
-    filterL.setSampleRate(hz);
-    filterR.setSampleRate(hz);
+    filter.setSampleRate(hz);
 }
 
 void
@@ -314,6 +358,7 @@ Muxer::synthesize(Cycle clock, Cycle target, long count)
         case SMP_NONE:    synthesize<SMP_NONE>   (clock, count, cyclesPerSample); break;
         case SMP_NEAREST: synthesize<SMP_NEAREST>(clock, count, cyclesPerSample); break;
         case SMP_LINEAR:  synthesize<SMP_LINEAR> (clock, count, cyclesPerSample); break;
+        case SMP_SINC:    synthesize<SMP_SINC>   (clock, count, cyclesPerSample); break;
         default:          assert(false);
     }
 }
@@ -323,7 +368,11 @@ Muxer::synthesize(Cycle clock, Cycle target)
 {
     assert(target > clock);
     assert(cyclesPerSample > 0);
-    
+
+    // Keep the fill level of the audio buffer close to the target value
+    adjustRate();
+    double cyclesPerSample = this->cyclesPerSample * (1.0 + rate.correction);
+
     // Determine how many samples we need to produce
     double exact = (double)(target - clock) / cyclesPerSample + fraction;
     long count = (long)exact;
@@ -333,6 +382,7 @@ Muxer::synthesize(Cycle clock, Cycle target)
         case SMP_NONE:    synthesize<SMP_NONE>   (clock, count, cyclesPerSample); break;
         case SMP_NEAREST: synthesize<SMP_NEAREST>(clock, count, cyclesPerSample); break;
         case SMP_LINEAR:  synthesize<SMP_LINEAR> (clock, count, cyclesPerSample); break;
+        case SMP_SINC:    synthesize<SMP_SINC>   (clock, count, cyclesPerSample); break;
         default:          assert(false);
 
     }
@@ -343,74 +393,128 @@ Muxer::synthesize(Cycle clock, long count, double cyclesPerSample)
 {
     assert(count > 0);
     
-    bool filter = ciaa.powerLED() || config.filterAlwaysOn;
+    bool useFilter = ciaa.powerLED() || config.filterAlwaysOn;
 
     // Check for a buffer overflow
     if (stream.count() + count >= stream.cap()) handleBufferOverflow();
 
+    // Select the sample source and the read cursors
+    Sampler *in = source ? source->sampler : sampler;
+    int &pos0 = source ? cursor[0] : sampler[0].r;
+    int &pos1 = source ? cursor[1] : sampler[1].r;
+    int &pos2 = source ? cursor[2] : sampler[2].r;
+    int &pos3 = source ? cursor[3] : sampler[3].r;
+
+    float c0[blockSize], c1[blockSize], c2[blockSize], c3[blockSize];
+    float *ch[4] = { c0, c1, c2, c3 };
+    float l[blockSize], r[blockSize];
+
     double cycle = clock;
-    for (size_t i = 0; i < count; i++) {
-
-        double ch0 = sampler[0].interpolate<method>((Cycle)cycle) * config.vol[0];
-        double ch1 = sampler[1].interpolate<method>((Cycle)cycle) * config.vol[1];
-        double ch2 = sampler[2].interpolate<method>((Cycle)cycle) * config.vol[2];
-        double ch3 = sampler[3].interpolate<method>((Cycle)cycle) * config.vol[3];
-
-        /*
-        if (this == &denise.screenRecorder.muxer)
-        {
-            dumpConfig();
-            debug("ch0: %f ch1: %f ch2: %f ch3: %f\n", ch0, ch1, ch2, ch3);
+    for (long done = 0; done < count; done += blockSize) {
+
+        int n = (int)MIN(count - done, (long)blockSize);
+
+        // Gather the channel samples
+        if (method == SMP_SINC) {
+
+            in[0].resample(cycle, cyclesPerSample, c0, n, pos0);
+            in[1].resample(cycle, cyclesPerSample, c1, n, pos1);
+            in[2].resample(cycle, cyclesPerSample, c2, n, pos2);
+            in[3].resample(cycle, cyclesPerSample, c3, n, pos3);
+
+            cycle += n * cyclesPerSample;
+
+        } else {
+
+            for (int i = 0; i < n; i++) {
+
+                c0[i] = in[0].interpolate<method>((Cycle)cycle, pos0);
+                c1[i] = in[1].interpolate<method>((Cycle)cycle, pos1);
+                c2[i] = in[2].interpolate<method>((Cycle)cycle, pos2);
+                c3[i] = in[3].interpolate<method>((Cycle)cycle, pos3);
+
+                cycle += cyclesPerSample;
+            }
         }
-        */
-        
-        // Compute left channel output
-        float l =
-        ch0 * config.pan[0] + ch1 * config.pan[1] +
-        ch2 * config.pan[2] + ch3 * config.pan[3];
-
-        // Compute right channel output
-        float r =
-        ch0 * (1 - config.pan[0]) + ch1 * (1 - config.pan[1]) +
-        ch2 * (1 - config.pan[2]) + ch3 * (1 - config.pan[3]);
-        
+
+        // Compute the left and the right channel output
+        mix(ch, l, r, n);
+
         // Apply audio filter
-        if (filter) { l = filterL.apply(l); r = filterR.apply(r); }
-        
-        // Write sample into ringbuffer
-        stream.write( SamplePair { l, r } );
-        
-        cycle += cyclesPerSample;
+        if (useFilter) filter.apply(l, r, n);
+
+        // Write samples into ringbuffer
+        for (int i = 0; i < n; i++) {
+            stream.write( SamplePair { l[i], r[i] } );
+        }
     }
 }
 
+void
+Muxer::mix(float **ch, float *left, float *right, int count)
+{
+    // On Intel machines, mix multiple samples at once
+    #if defined(__i386__) || defined(__x86_64__)
+
+    if (!NO_SSE) {
+        mixSSE(ch, gainL, gainR, left, right, count);
+        return;
+    }
+
+    #endif
+
+    for (int i = 0; i < count; i++) {
+
+        float s0 = ch[0][i], s1 = ch[1][i], s2 = ch[2][i], s3 = ch[3][i];
+
+        left[i] =
+        s0 * gainL[0] + s1 * gainL[1] + s2 * gainL[2] + s3 * gainL[3];
+
+        right[i] =
+        s0 * gainR[0] + s1 * gainR[1] + s2 * gainR[2] + s3 * gainR[3];
+    }
+}
+
+void
+Muxer::adjustRate()
+{
+    // Don't adjust the rate if the emulator doesn't run in real time
+    if (warpMode || amiga.isRendering()) return;
+
+    double target = targetLevel();
+    if (rate.update((double)stream.count(), target)) stats.saturations++;
+
+    // Update telemetry
+    stats.fillLevel = rate.level;
+    stats.targetLevel = target;
+    stats.correction = rate.correction * 1000000.0;
+    stats.drift = rate.integral * 1000000.0;
+
+    trace(AUDBUF_DEBUG, "fill: %.0f target: %.0f correction: %.0f ppm\n",
+          rate.level, target, stats.correction);
+}
+
 void
 Muxer::handleBufferUnderflow()
 {
     // There are two common scenarios in which buffer underflows occur:
     //
-    // (1) The consumer runs slightly faster than the producer
+    // (1) The consumer runs faster than the rate control can compensate
     // (2) The producer is halted or not startet yet
     
     trace(AUDBUF_DEBUG, "UNDERFLOW (r: %d w: %d)\n", stream.r, stream.w);
     
-    // Reset the write pointer
-    stream.alignWritePtr();
+    // Reset the write pointer and restart the rate control
+    stream.alignWritePtr((u32)targetLevel());
+    rate.reset(targetLevel());
 
     // Determine the elapsed seconds since the last pointer adjustment
-    u64 now = mach_absolute_time();
+    u64 now = nanos();
     double elapsedTime = (double)(now - lastAlignment) / 1000000000.0;
     lastAlignment = now;
     
-    // Adjust the sample rate, if condition (1) holds
-    if (elapsedTime > 10.0) {
-
-        stats.bufferUnderflows++;
-        
-        // Increase the sample rate based on what we've measured
-        int offPerSecond = (int)(stream.count() / elapsedTime);
-        setSampleRate(getSampleRate() + offPerSecond);
-    }
+    // Only count the underflow if condition (1) holds
+    if (elapsedTime > 10.0) stats.bufferUnderflows++;
 }
 
 void
@@ -418,32 +522,23 @@ Muxer::handleBufferOverflow()
 {
     // There are two common scenarios in which buffer overflows occur:
     //
-    // (1) The consumer runs slightly slower than the producer
+    // (1) The consumer runs slower than the rate control can compensate
     // (2) The consumer is halted or not startet yet
     
     trace(AUDBUF_DEBUG, "OVERFLOW (r: %d w: %d)\n", stream.r, stream.w);
     
-    // Reset the write pointer
-    stream.alignWritePtr();
+    // Reset the write pointer and restart the rate control
+    stream.alignWritePtr((u32)targetLevel());
+    rate.reset(targetLevel());
 
     // Determine the number of elapsed seconds since the last adjustment
-    u64 now = mach_absolute_time();
+    u64 now = nanos();
     double elapsedTime = (double)(now - lastAlignment) / 1000000000.0;
     lastAlignment = now;
     trace(AUDBUF_DEBUG, "elapsedTime: %f\n", elapsedTime);
     
-    // Adjust the sample rate, if condition (1) holds
-    if (elapsedTime > 10.0) {
-        
-        stats.bufferOverflows++;
-        
-        // Decrease the sample rate based on what we've measured
-        int offPerSecond = (int)(stream.count() / elapsedTime);
-        double newSampleRate = getSampleRate() - offPerSecond;
-
-        trace(AUDBUF_DEBUG, "Changing sample rate to %f\n", newSampleRate);
-        setSampleRate(newSampleRate);
-    }
+    // Only count the overflow if condition (1) holds
+    if (elapsedTime > 10.0) stats.bufferOverflows++;
 }
 
 void
@@ -60,8 +60,56 @@ struct Volume {
     }
 };
 
+/* Adaptive rate control. To keep the producer (the emulator) and the consumer
+ * (the audio device of the host) in sync, the muxer stretches or compresses
+ * the generated audio stream by a tiny amount. The correction is computed by
+ * a PI controller based on the smoothed fill level of the audio buffer. The
+ * integral part converges to the clock drift between emulator and host.
+ */
+struct RateControl {
+
+    // Maximum deviation from the nominal rate (0.5 %)
+    static constexpr double maxCorrection = 0.005;
+
+    // Controller gains
+    static constexpr double kp = 0.01;
+    static constexpr double ki = 0.00003;
+
+    // Smoothing factor applied to the measured fill level
+    static constexpr double alpha = 0.05;
+
+    // Smoothed fill level
+    double level = 0;
+
+    // Integral part of the controller
+    double integral = 0;
+
+    // Current correction (relative deviation from the nominal rate)
+    double correction = 0;
+
+    // Restarts the controller at the specified fill level
+    void reset(double fill) { level = fill; correction = integral; }
+
+    // Feeds in a new measurement and returns true if the limit is reached
+    bool update(double fill, double target) {
+
+        level += alpha * (fill - level);
+        double error = (level - target) / target;
+
+        integral += ki * error;
+        integral = MAX(-maxCorrection, MIN(integral, maxCorrection));
+
+        correction = kp * error + integral;
+        if (correction > maxCorrection) { correction = maxCorrection; return true; }
+        if (correction < -maxCorrection) { correction = -maxCorrection; return true; }
+        return false;
+    }
+};
+
 class Muxer : public AmigaComponent {
 
+    friend class MuxerBench;
+
     // Current configuration
     MuxerConfig config;
     
@@ -82,6 +130,23 @@ class Muxer : public AmigaComponent {
 
     // Volume control
     Volume volume;
+
+    // Rate control
+    RateControl rate;
+
+    /* Gains applied to the four channels when mixing the left and the right
+     * output. The values combine the channel volumes and the pan settings and
+     * are recomputed whenever one of them changes.
+     */
+    float gainL[4];
+    float gainR[4];
+
+    /* Optional sample source. If set, the muxer doesn't read from its own
+     * samplers. Instead, it reads the samplers of the source muxer through a
+     * set of private read cursors, leaving the source untouched.
+     */
+    Muxer *source = NULL;
+    int cursor[4];
         
     
     //
@@ -96,9 +161,8 @@ public:
     // Output
     AudioStream stream;
     
-    // Audio filters
-    AudioFilter filterL = AudioFilter(amiga);
-    AudioFilter filterR = AudioFilter(amiga);
+    // Audio filter (applied to both stereo channels)
+    AudioFilter filter = AudioFilter(amiga);
         
     
     //
@@ -111,11 +175,16 @@ public:
     
     void _reset(bool hard) override;
     
-    // Resets the output buffer and the two audio filters
+    // Resets the output buffer and the audio filter
     void clear();
 
     // Replaces the audio stream by a stream from a different muxer
     // void cloneStream(AudioStream &other) { stream = other; }
+
+    /* Connects the muxer to the samplers of another muxer. The read cursors
+     * are set to the current read positions of the source.
+     */
+    void attach(Muxer &other);
     
     
     //
@@ -134,10 +203,16 @@ public:
     double getSampleRate() { return sampleRate; }
     void setSampleRate(double hz);
 
+    // Returns the targeted fill level of the audio buffer in samples
+    double targetLevel() { return config.latency * sampleRate / 1000.0; }
+
 private:
     
     void _dumpConfig() override;
 
+    // Recomputes the mixing gains from the current configuration
+    void updateGains();
+
 
     //
     // Analyzing
@@ -166,7 +241,8 @@ private:
         & config.vol
         & config.pan
         & config.volL
-        & config.volR;
+        & config.volR
+        & config.latency;
     }
     
     template <class T>
@@ -186,6 +262,7 @@ private:
     size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
     size_t _load(u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
     size_t _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    size_t didLoadFromBuffer(u8 *buffer) override { updateGains(); return 0; }
     
     
     //
@@ -220,9 +297,18 @@ public:
 
 private:
 
+    // Number of samples that are processed in a single block
+    static const int blockSize = 256;
+
     template <SamplingMethod method>
     void synthesize(Cycle clock, long count, double cyclesPerSample);
+
+    // Mixes a block of channel samples into the left and the right output
+    void mix(float **ch, float *left, float *right, int count);
     
+    // Adjusts the rate based on the current fill level of the audio buffer
+    void adjustRate();
+
     // Handles a buffer underflow or overflow condition
     void handleBufferUnderflow();
     void handleBufferOverflow();
@@ -230,7 +316,7 @@ private:
 public:
     
     // Signals to ignore the next underflow or overflow condition
-    void ignoreNextUnderOrOverflow() { lastAlignment = mach_absolute_time(); }
+    void ignoreNextUnderOrOverflow() { lastAlignment = nanos(); }
 
 
     //
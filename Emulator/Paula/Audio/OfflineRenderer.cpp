@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Amiga.h"
+
+OfflineRenderer::OfflineRenderer(Amiga& ref) : AmigaComponent(ref)
+{
+    setDescription("OfflineRenderer");
+
+    subComponents = vector<HardwareComponent *> {
+
+        &muxer
+    };
+
+    muxer.setDescription("OfflineMuxer");
+}
+
+void
+OfflineRenderer::begin()
+{
+    muxer.setSampleRate(paula.muxer.getSampleRate());
+    muxer.clear();
+    muxer.stream.clear();
+    muxer.attach(paula.muxer);
+
+    audioClock = paula.audioClock;
+    fraction = 0;
+}
+
+long
+OfflineRenderer::synthesize(float *left, float *right, long capacity)
+{
+    Cycle target = paula.audioClock;
+    if (target <= audioClock) return 0;
+
+    // Determine how many samples we need to produce
+    double cyclesPerSample = MHz(masterClockFrequency) / muxer.getSampleRate();
+    double exact = (double)(target - audioClock) / cyclesPerSample + fraction;
+    long count = (long)exact;
+    fraction = exact - (double)count;
+
+    if (count > 0) muxer.synthesize(audioClock, target, count);
+    audioClock = target;
+
+    // Hand the samples over
+    count = MIN(count, capacity);
+    muxer.copyStereo(left, right, count);
+    muxer.stream.clear();
+
+    return count;
+}
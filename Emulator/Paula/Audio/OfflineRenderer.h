@@ -0,0 +1,95 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#ifndef _OFFLINE_RENDERER_H
+#define _OFFLINE_RENDERER_H
+
+#include "AmigaComponent.h"
+#include "Muxer.h"
+
+/* The offline renderer synthesizes an audio stream that is independent of the
+ * host audio device. It owns a private muxer which reads Paula's sample
+ * history through its own set of cursors (see Muxer::attach()). The number of
+ * samples per frame is derived solely from the elapsed emulation cycles and
+ * the sample rate. Neither the adaptive rate control nor the volume ramps of
+ * the main muxer are involved. Hence, rendering the same emulation state
+ * twice produces the same output.
+ *
+ * The renderer is driven by Amiga::renderAudio() which runs the emulator
+ * in the calling thread as fast as possible.
+ */
+class OfflineRenderer : public AmigaComponent {
+
+    // Audio muxer for synthesizing the rendered stream
+    Muxer muxer = Muxer(amiga);
+
+    // The rendered stream has been synthesized up to this cycle
+    Cycle audioClock = 0;
+
+    // Fraction of a sample that hadn't been generated in synthesize
+    double fraction = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    OfflineRenderer(Amiga& ref);
+
+    void _reset(bool hard) override { RESET_SNAPSHOT_ITEMS(hard) }
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    template <class T>
+    void applyToPersistentItems(T& worker)
+    {
+    }
+
+    template <class T>
+    void applyToHardResetItems(T& worker)
+    {
+    }
+
+    template <class T>
+    void applyToResetItems(T& worker)
+    {
+    }
+
+    size_t _size() override { COMPUTE_SNAPSHOT_SIZE }
+    size_t _load(u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
+    size_t _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+
+
+    //
+    // Rendering
+    //
+
+public:
+
+    // Returns the sample rate of the rendered stream
+    double getSampleRate() { return muxer.getSampleRate(); }
+
+    // Starts a new stream at the current position of Paula's audio unit
+    void begin();
+
+    /* Synthesizes all samples up to the current position of Paula's audio
+     * unit and copies them into the provided buffers. At most 'capacity'
+     * samples are copied. The function returns the number of copied samples.
+     */
+    long synthesize(float *left, float *right, long capacity);
+};
+
+#endif
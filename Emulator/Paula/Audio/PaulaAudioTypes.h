@@ -21,6 +21,7 @@ typedef VA_ENUM(long, SamplingMethod)
     SMP_NONE,
     SMP_NEAREST,
     SMP_LINEAR,
+    SMP_SINC,
     SMP_COUNT
 };
 
@@ -35,6 +36,7 @@ static inline const char *sSamplingMethod(SamplingMethod value)
         case SMP_NONE:     return "SMP_NONE";
         case SMP_NEAREST:  return "SMP_NEAREST";
         case SMP_LINEAR:   return "SMP_LINEAR";
+        case SMP_SINC:     return "SMP_SINC";
         default:           return "???";
     }
 }
@@ -103,6 +105,9 @@ typedef struct
     // Output channel volumes
     double volL;
     double volR;
+
+    // Targeted fill level of the audio buffer in msec
+    long latency;
 }
 MuxerConfig;
 
@@ -110,6 +115,17 @@ typedef struct
 {
     long bufferUnderflows;
     long bufferOverflows;
+
+    // Smoothed and targeted fill level of the audio buffer in samples
+    double fillLevel;
+    double targetLevel;
+
+    // Current rate correction and estimated clock drift in ppm
+    double correction;
+    double drift;
+
+    // Number of frames in which the rate correction hit its limit
+    long saturations;
 }
 MuxerStats;
 
@@ -8,41 +8,45 @@
 // -----------------------------------------------------------------------------
 
 #include "Sampler.h"
+#include "SSEUtils.h"
+#include <math.h>
 
 template <SamplingMethod method> i16
 Sampler::interpolate(Cycle clock)
 {
     assert(!isEmpty());
 
-    int r1 = r;
+    return interpolate<method>(clock, r);
+}
+
+template <SamplingMethod method> i16
+Sampler::interpolate(Cycle clock, int &cursor)
+{
+    assert(cursor != w);
+
+    u32 now = (u32)clock;
+    int r1 = cursor;
     int r2 = next(r1);
 
-    // Remove all outdated entries
-    while (r2 != w && elements[r2].tag <= clock) {
-        (void)read();
+    // Skip all outdated entries
+    while (r2 != w && (i32)(now - tags[r2]) >= 0) {
         r1 = r2;
         r2 = next(r1);
     }
+    cursor = r1;
 
     // If the buffer contains a single element only, return that element
     if (r2 == w) {
-        return elements[r1].sample;
+        return samples[r1];
     }
 
     // Interpolate between position r1 and r2
-    Cycle c1 = elements[r1].tag;
-    Cycle c2 = elements[r2].tag;
-    i16 s1 = elements[r1].sample;
-    i16 s2 = elements[r2].sample;
-    
-    /*
-    if (!(clock >= c1 && clock < c2)) {
-        printf("WARNING: clock: %lld count: %d r: %d w: %d r1: %d r2: %d c1: %lld c2: %lld\n", clock, count(), r, w, r1, r2, c1, c2);
-        return 0;
-        
-    }
-    */
-    assert(clock >= c1 && clock < c2);
+    u32 dx = tags[r2] - tags[r1];
+    u32 dc = now - tags[r1];
+    i16 s1 = samples[r1];
+    i16 s2 = samples[r2];
+
+    assert(dc < dx);
 
     switch (method) {
 
@@ -52,7 +56,7 @@ Sampler::interpolate(Cycle clock)
         }
         case SMP_NEAREST:
         {
-            if (clock - c1 < c2 - clock) {
+            if (dc < dx - dc) {
                 return s1;
             } else {
                 return s2;
@@ -60,9 +64,8 @@ Sampler::interpolate(Cycle clock)
         }
         case SMP_LINEAR:
         {
-            double dx = (double)(c2 - c1);
             double dy = (double)(s2 - s1);
-            double weight = (double)(clock - c1) / dx;
+            double weight = (double)dc / (double)dx;
             return (i16)(s1 + weight * dy);
         }
         default:
@@ -71,6 +74,140 @@ Sampler::interpolate(Cycle clock)
     }
 }
 
+static void
+addResponse(float *target, const float *row0, const float *row1,
+            float weight, float delta, int count)
+{
+    // On Intel machines, process multiple taps at once
+    #if defined(__i386__) || defined(__x86_64__)
+
+    if (!NO_SSE) {
+        blepSSE(target, row0, row1, weight, delta, count);
+        return;
+    }
+
+    #endif
+
+    for (int i = 0; i < count; i++) {
+        target[i] += delta * (row0[i] + weight * (row1[i] - row0[i]));
+    }
+}
+
+void
+Sampler::resample(double clock, double cyclesPerSample,
+                  float *out, int count, int &cursor)
+{
+    const int W = BlepTable::width;
+    const int P = BlepTable::phases;
+    const BlepTable &table = BlepTable::get();
+
+    assert(cursor != w);
+    assert(count <= 1024);
+
+    /* Step responses are accumulated in 'acc' which is offset by 2W to cover
+     * steps whose response starts before the block. Settled steps are added
+     * to 'settled' at the position where their response reaches one.
+     */
+    float acc[1024 + 4 * W];
+    float settled[1024];
+    memset(acc, 0, sizeof(float) * (count + 4 * W));
+    memset(settled, 0, sizeof(float) * count);
+
+    u32 base = (u32)(Cycle)clock;
+    double frac = clock - floor(clock);
+    double scale = 1.0 / cyclesPerSample;
+
+    // Skip all steps which have settled before the block starts
+    u32 lo = (u32)(Cycle)(clock - W * cyclesPerSample);
+    int r1 = cursor;
+    int r2 = next(r1);
+    while (r2 != w && (i32)(lo - tags[r2]) >= 0) {
+        r1 = r2;
+        r2 = next(r1);
+    }
+    cursor = r1;
+
+    float level = samples[r1];
+    float prev = level;
+
+    for (int j = r2; j != w; j = next(j)) {
+
+        // Determine the step position in output samples
+        double pos = ((double)(i32)(tags[j] - base) - frac) * scale;
+        if (pos >= count - 1 + W) break;
+
+        float delta = samples[j] - prev;
+        prev = samples[j];
+        if (delta == 0) continue;
+
+        // Determine the first affected output sample and the filter phase
+        double start = pos - W;
+        int first = (int)ceil(start);
+        double phase = (first - start) * P;
+        int ph = MIN((int)phase, P - 1);
+        float weight = (float)(phase - ph);
+
+        // Add the step response
+        addResponse(acc + first + 2 * W,
+                    table.row[ph], table.row[ph + 1], weight, delta, 2 * W);
+
+        // Record the position where the step has settled
+        int end = first + 2 * W;
+        if (end < count) settled[MAX(end, 0)] += delta;
+    }
+
+    // Combine both parts
+    for (int i = 0; i < count; i++) {
+        level += settled[i];
+        out[i] = level + acc[i + 2 * W];
+    }
+}
+
+BlepTable::BlepTable()
+{
+    const int W = width;
+    const int P = phases;
+    const int sub = 16;
+    const int n = 2 * W * P * sub;
+
+    // Integrate the windowed sinc function numerically
+    double *step = new double[n + 1];
+    step[0] = 0;
+
+    for (int i = 0; i < n; i++) {
+
+        // Evaluate the kernel in the middle of the integration interval
+        double x = -W + (i + 0.5) / (P * sub);
+        double t = 2 * M_PI * cutoff * x;
+        double sinc = t == 0 ? 1.0 : sin(t) / t;
+        double win =
+        0.42 + 0.5 * cos(M_PI * x / W) + 0.08 * cos(2 * M_PI * x / W);
+
+        step[i + 1] = step[i] + sinc * win;
+    }
+
+    // Normalize the step response and fill the table
+    for (int ph = 0; ph <= P; ph++) {
+        for (int k = 0; k < 2 * W; k++) {
+            int i = (k * P + ph) * sub;
+            row[ph][k] = i < n ? (float)(step[i] / step[n]) : 1.0f;
+        }
+    }
+
+    delete [] step;
+}
+
+const BlepTable &
+BlepTable::get()
+{
+    static BlepTable table;
+    return table;
+}
+
 template i16 Sampler::interpolate<SMP_NONE>(Cycle clock);
 template i16 Sampler::interpolate<SMP_NEAREST>(Cycle clock);
 template i16 Sampler::interpolate<SMP_LINEAR>(Cycle clock);
+template i16 Sampler::interpolate<SMP_NONE>(Cycle clock, int &cursor);
+template i16 Sampler::interpolate<SMP_NEAREST>(Cycle clock, int &cursor);
+template i16 Sampler::interpolate<SMP_LINEAR>(Cycle clock, int &cursor);
+template i16 Sampler::interpolate<SMP_SINC>(Cycle clock, int &cursor);
@@ -35,8 +35,108 @@ struct TaggedSample
     }
 };
 
-struct Sampler : RingBuffer <TaggedSample, VPOS_CNT * HPOS_CNT> {
-    
+/* The sampler stores the tagged samples in a compact format. Cycle tags are
+ * stored as 32-bit values which are the lower bits of the master clock. As
+ * long as two tags are less than 2^31 cycles apart, the difference between
+ * them can be computed correctly by 32-bit wrap-around arithmetic, which is
+ * all the interpolation code requires. Tags and samples are kept in separate
+ * arrays to minimize the memory footprint (6 bytes per entry instead of 16).
+ *
+ * The muxer consumes the sampler contents once per frame. Hence, the buffer
+ * only needs to hold the samples of a single frame plus some slack. The
+ * chosen capacity is sufficient for periods down to about three DMA cycles.
+ * For even smaller periods, the state machine drops samples.
+ */
+struct Sampler {
+
+    // Number of entries (must be a power of two)
+    static const int capacity = 1 << 15;
+
+    // Cycle tags (lower 32 bits of the master clock)
+    u32 tags[capacity];
+
+    // Sample values
+    i16 samples[capacity];
+
+    // Read and write pointers
+    int r, w;
+
+
+    //
+    // Initializing
+    //
+
+    Sampler() { clear(); }
+
+    void clear() { r = w = 0; }
+
+
+    //
+    // Serializing
+    //
+
+    // Only the live window between the read and the write pointer is saved
+    template <class W>
+    void applyToItems(W& worker)
+    {
+        int cnt = count();
+        worker & cnt;
+
+        for (int i = 0, j = r; i < cnt; i++, j = next(j)) {
+            worker & tags[j] & samples[j];
+        }
+        w = (r + cnt) & (capacity - 1);
+    }
+
+
+    //
+    // Querying the fill status
+    //
+
+    int cap() const { return capacity; }
+    int count() const { return (w - r) & (capacity - 1); }
+    bool isEmpty() const { return r == w; }
+    bool isFull() const { return count() == capacity - 1; }
+
+
+    //
+    // Working with indices
+    //
+
+    static int next(int i) { return (i + 1) & (capacity - 1); }
+    static int prev(int i) { return (i - 1) & (capacity - 1); }
+
+
+    //
+    // Reading and writing
+    //
+
+    void write(TaggedSample element)
+    {
+        assert(!isFull());
+
+        u32 tag = (u32)element.tag;
+
+        /* Keep the distance to the predecessor in the valid range. The tag
+         * of the predecessor is only moved if no sample has been written for
+         * a very long time. Since the sample value stays the same, this
+         * doesn't change the interpolated output.
+         */
+        if (!isEmpty()) {
+            int p = prev(w);
+            if (tag - tags[p] > 0x40000000) tags[p] = tag - 0x40000000;
+        }
+
+        tags[w] = tag;
+        samples[w] = element.sample;
+        w = next(w);
+    }
+
+
+    //
+    // Interpolating
+    //
+
     /* Interpolates a sound sample for the specified target cycle. Two major
      * steps are involved. In the first step, the function computes index
      * position r1 with the following property:
@@ -47,6 +147,54 @@ struct Sampler : RingBuffer <TaggedSample, VPOS_CNT * HPOS_CNT> {
      * r1 and r1 + 1 based on the requested method.
      */
     template <SamplingMethod method> i16 interpolate(Cycle clock);
+
+    /* Interpolates a sound sample using an external read cursor. This variant
+     * leaves the read pointer untouched and advances the provided cursor
+     * instead. It allows a secondary consumer (e.g., the screen recorder) to
+     * read the sample history without interfering with the primary one. The
+     * cursor has to point to a live element between the read and the write
+     * pointer, or to an element that has recently been passed by the read
+     * pointer.
+     */
+    template <SamplingMethod method> i16 interpolate(Cycle clock, int &cursor);
+
+    /* Computes a block of band-limited samples for the cycles clock,
+     * clock + cyclesPerSample, clock + 2 * cyclesPerSample, etc. The tagged
+     * samples are treated as a step function. Each step is replaced by the
+     * step response of a windowed-sinc lowpass filter which is looked up in a
+     * precomputed polyphase table (see BlepTable). Because the step response
+     * reaches into the future, samples up to blepWidth output samples beyond
+     * the block have to be present. The cursor is kept blepWidth output
+     * samples behind the block start, because the steps in this range still
+     * contribute to the output.
+     */
+    void resample(double clock, double cyclesPerSample,
+                  float *out, int count, int &cursor);
+};
+
+/* Polyphase table of a band-limited step (BLEP). Row i contains the step
+ * response of a Blackman-windowed sinc lowpass, sampled at the distances
+ * -W + i/P, -W + i/P + 1, ..., W - 1 + i/P, where W is the half width of the
+ * filter in output samples and P the number of phases.
+ */
+struct BlepTable {
+
+    // Half width of the filter kernel in output samples
+    static const int width = 16;
+
+    // Number of phases (sub-sample resolution)
+    static const int phases = 64;
+
+    // Cutoff frequency relative to the output sample rate
+    static constexpr double cutoff = 0.45;
+
+    // The step responses (one extra row simplifies phase interpolation)
+    float row[phases + 1][2 * width];
+
+    BlepTable();
+
+    // Returns the table (computed on first use)
+    static const BlepTable &get();
 };
 
 #endif
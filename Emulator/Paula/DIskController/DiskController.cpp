@@ -21,6 +21,11 @@ DiskController::DiskController(Amiga& ref) : AmigaComponent(ref)
     config.speed = 1;
     config.lockDskSync = false;
     config.autoDskSync = false;
+    config.hle = false;
+    config.hleDelay = 150;
+    config.autoWarp = false;
+
+    clearStats();
 }
 
 void
@@ -31,6 +36,9 @@ DiskController::_reset(bool hard)
     prb = 0xFF;
     selected = -1;
     dsksync = 0x4489;
+    dmaCycle = 0;
+    
+    scheduleFirstDiskEvent();
     
     if (hard) {
         assert(diskToInsert == NULL);
@@ -45,6 +53,9 @@ DiskController::getConfigItem(ConfigOption option)
         case OPT_DRIVE_SPEED:   return config.speed;
         case OPT_AUTO_DSKSYNC:  return config.autoDskSync;
         case OPT_LOCK_DSKSYNC:  return config.lockDskSync;
+        case OPT_DISK_HLE:      return config.hle;
+        case OPT_DISK_HLE_DELAY: return config.hleDelay;
+        case OPT_AUTO_WARP:     return config.autoWarp;
         
         default: assert(false);
     }
@@ -104,6 +115,37 @@ DiskController::setConfigItem(ConfigOption option, long value)
             config.lockDskSync = value;
             return true;
             
+        case OPT_DISK_HLE:
+            
+            if (config.hle == value) {
+                return false;
+            }
+            
+            config.hle = value;
+            return true;
+            
+        case OPT_DISK_HLE_DELAY:
+            
+            if (value < 0) {
+                warn("Invalid HLE delay: %d\n", value);
+                return false;
+            }
+            if (config.hleDelay == value) {
+                return false;
+            }
+            
+            config.hleDelay = value;
+            return true;
+            
+        case OPT_AUTO_WARP:
+            
+            if (config.autoWarp == value) {
+                return false;
+            }
+            
+            config.autoWarp = value;
+            return true;
+            
         default:
             return false;
     }
@@ -142,6 +184,9 @@ DiskController::_dumpConfig()
     msg("        Speed : %d\n", config.speed);
     msg("  lockDskSync : %s\n", config.lockDskSync ? "yes" : "no");
     msg("  autoDskSync : %s\n", config.autoDskSync ? "yes" : "no");
+    msg("          HLE : %s\n", config.hle ? "yes" : "no");
+    msg("    HLE delay : %d usec\n", config.hleDelay);
+    msg("    Auto warp : %s\n", config.autoWarp ? "yes" : "no");
 }
 
 void
@@ -212,6 +257,7 @@ DiskController::setState(DriveState oldState, DriveState newState)
           driveStateName(oldState), driveStateName(newState));
     
     state = newState;
+    if (oldState != DRIVE_DMA_OFF) dmaCycle = agnus.clock;
     
     switch (state) {
 
@@ -575,7 +621,7 @@ DiskController::performTurboDMA(Drive *drive)
 
         case DRIVE_DMA_WAIT:
 
-            drive->findSyncMark();
+            if (drive) drive->findSyncMark();
             fallthrough;
 
         case DRIVE_DMA_READ:
@@ -649,3 +695,93 @@ DiskController::performTurboWrite(Drive *drive)
     }
 }
 
+bool
+DiskController::performHLERead(Drive *drive)
+{
+    if (!config.hle || !drive) return false;
+    
+    // Only proceed if the drive delivers data from an Amiga disk
+    Disk *disk = drive->disk;
+    if (!disk || !isAmigaDiskType(disk->getType())) return false;
+    if (!drive->motor || drive->isStepping(agnus.clock)) return false;
+    
+    // Only proceed if the request matches a trackdisk.device read
+    if (dsksync != 0x4489 || !agnus.dskdma()) return false;
+
+    long bytes = 2 * (dsklen & 0x3FFF);
+    long minBytes = disk->getNumSectors() * disk->getSectorSize();
+    long maxBytes = 2 * disk->getTrackSize();
+    if (bytes < minBytes || bytes > maxBytes) return false;
+    
+    Track t = 2 * drive->head.cylinder + drive->head.side;
+    if (disk->nextSyncMark(t, 0x4489, 0) < 0) return false;
+
+    // Only proceed if the data ends up in Chip Ram
+    u8 *dst = mem.chipBlock(agnus.dskpt & agnus.ptrMask, bytes);
+    if (!dst) return false;
+    
+    trace(DSK_DEBUG, "HLE read: cyl: %d side: %d bytes: %d dskpt: %x\n",
+          drive->head.cylinder, drive->head.side, bytes, agnus.dskpt);
+
+    // Transfer the track
+    drive->findSyncMark();
+    paula.raiseIrq(INT_DSKSYN);
+    drive->readBlockAndRotate(dst, bytes);
+    agnus.dskpt += bytes;
+    
+    // Trigger the disk interrupt with the configured delay
+    paula.scheduleIrqRel(INT_DSKBLK, USEC(config.hleDelay));
+
+    setState(DRIVE_DMA_OFF);
+    return true;
+}
+
+void
+DiskController::vsyncHandler()
+{
+    // Record the disk activity of the previous frame
+    if (state != DRIVE_DMA_OFF) dmaCycle = agnus.clock;
+
+    if (autoWarping) {
+        stats.warpFrames++;
+        if (denise.skipFrame) stats.skippedFrames++;
+    }
+    
+    updateAutoWarp();
+}
+
+void
+DiskController::updateAutoWarp()
+{
+    // The clock may have been reset by loading a snapshot
+    if (dmaCycle > agnus.clock) dmaCycle = agnus.clock;
+    if (warpStartCycle > agnus.clock) warpStartCycle = agnus.clock;
+
+    // Check for recent disk activity
+    bool active = config.autoWarp && spinning() && agnus.clock - dmaCycle < MSEC(500);
+    
+    if (active && !autoWarping && !amiga.inWarpMode()) {
+        
+        trace(DSK_DEBUG, "Entering auto-warp mode\n");
+        
+        autoWarping = true;
+        warpStartCycle = agnus.clock;
+        warpStartNanos = amiga.time_in_nanos();
+        stats.autoWarps++;
+        
+        amiga.switchWarp(true);
+    }
+    
+    if (!active && autoWarping) {
+        
+        trace(DSK_DEBUG, "Leaving auto-warp mode\n");
+        
+        autoWarping = false;
+        stats.warpCycles += agnus.clock - warpStartCycle;
+        stats.warpNanos += amiga.time_in_nanos() - warpStartNanos;
+        
+        // Don't interfere if warp mode has been switched off in the meantime
+        if (amiga.inWarpMode()) amiga.switchWarp(false);
+    }
+}
+
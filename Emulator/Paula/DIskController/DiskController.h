@@ -22,6 +22,9 @@ class DiskController : public AmigaComponent {
     // Result of the latest inspection
     DiskControllerInfo info;
 
+    // Collected statistical information
+    DiskControllerStats stats;
+
     // Temorary storage for a disk waiting to be inserted
     class Disk *diskToInsert = NULL;
 
@@ -41,8 +44,35 @@ class DiskController : public AmigaComponent {
      */
     i16 syncCounter = 0;
     
-    // Used to synchronize the schedulign of the DSK_ROTATE event
-    double dskEventDelay = 0;
+    // Timestamp of the latest disk DMA activity
+    Cycle dmaCycle = 0;
+
+    /* Auto-warp state. If auto-warp is enabled, the controller puts the
+     * emulator into warp mode as long as a drive motor is on and disk DMA
+     * has been performed recently. Warp mode is only left automatically if
+     * it has been entered automatically.
+     */
+    bool autoWarping = false;
+    Cycle warpStartCycle = 0;
+    u64 warpStartNanos = 0;
+    
+    /* Disk rotation is emulated analytically. The controller receives a new
+     * byte from the selected drive every 55.98 DMA cycles (300 rpm). Instead
+     * of processing each byte in a separate event, the number of received
+     * bytes is derived from the current clock. As long as disk DMA is idle,
+     * bytes without an observable effect are skipped in bulk and the
+     * DSK_ROTATE event is only scheduled for the next byte that raises a SYNC
+     * interrupt or triggers an index pulse.
+     */
+    
+    // Time stamp of the first byte
+    Cycle rotationAnchor = 0;
+    
+    // Number of bytes that have been received since rotationAnchor
+    i64 rotationTicks = 0;
+    
+    // The next byte that has to be processed individually (NEVER if none)
+    i64 plannedTick = 0;
     
     
     //
@@ -126,6 +156,9 @@ public:
     
     DiskControllerInfo getInfo() { return HardwareComponent::getInfo(info); }
     
+    DiskControllerStats getStats() { return stats; }
+    void clearStats() { memset(&stats, 0, sizeof(stats)); }
+    
 private:
     
     void _inspect() override;
@@ -146,7 +179,10 @@ private:
         & config.connected
         & config.speed
         & config.lockDskSync
-        & config.autoDskSync;
+        & config.autoDskSync
+        & config.hle
+        & config.hleDelay
+        & config.autoWarp;
     }
 
     template <class T>
@@ -163,7 +199,9 @@ private:
         & state
         & syncCycle
         & syncCounter
-        & dskEventDelay
+        & rotationAnchor
+        & rotationTicks
+        & plannedTick
         & incoming
         & fifo
         & fifoCount
@@ -271,6 +309,39 @@ public:
     // Services an event in the disk change slot
     void serviceDiskChangeEvent();
 
+    // Called by Agnus at the beginning of each frame
+    void vsyncHandler();
+
+    /* Processes all bytes the selected drive has delivered up to now. This
+     * function needs to be called before the drive state or the controller
+     * state is observed or changed. After a change, the next event has to be
+     * rescheduled with scheduleNextDiskEvent().
+     */
+    void catchUp();
+
+private:
+
+    // Returns the cycle when the n-th byte is received
+    Cycle tickCycle(i64 n);
+    
+    // Returns the number of bytes received up to (and including) a cycle
+    i64 ticksUntil(Cycle cycle);
+    
+    // Checks if the FIFO is operated without disk DMA
+    bool isIdle() { return state == DRIVE_DMA_OFF || state == DRIVE_DMA_WAIT; }
+    
+    /* Determines the next byte with an observable effect. This is a byte
+     * that completes a SYNC mark, triggers an index pulse, fires the auto
+     * DSKSYNC watchdog, or is the first byte after a head movement.
+     */
+    i64 nextObservableTick();
+    
+    /* Skips multiple bytes in idle state. This function has the same effect
+     * as calling executeFifo() count times if none of the bytes has an
+     * observable effect.
+     */
+    void skipTicks(i64 count);
+
     
     //
     // Working with the FIFO buffer
@@ -331,8 +402,8 @@ public:
      *
      * If the FIFO buffer is emulated asynchronously, the event scheduler
      * is utilized to execute a DSK_ROTATE event from time to time. Whenever
-     * this event triggers, a byte is read from the disk drive and fed into
-     * the buffer. If the FIFO buffer is emulated synchronously, the DSK_ROTATE
+     * this event triggers, all bytes delivered by the drive since the last
+     * event are fed into the buffer. If the FIFO buffer is emulated synchronously, the DSK_ROTATE
      * events have no effect. Instead, the FIFO buffer is filled at the same
      * time when the drive DMA slots are processed. Synchronous mode is
      * slightly faster, because the FIFO can never run out of data. It is filled
@@ -349,7 +420,13 @@ public:
      * register is written to. This mode is fast, but far from being accurate.
      * Neither does it uses the disk DMA slots, nor does it interact with
      * the FIFO buffer.
-
+     *
+     * Independently of the DMA mode, standard trackdisk.device reads can be
+     * emulated on a high level. If HLE is enabled, a read request is
+     * recognized by its typical pattern (a word-synced read with SYNC word
+     * 0x4489 that covers all sectors of an Amiga track). Such a request is
+     * carried out by copying the MFM encoded track into Chip Ram in a
+     * single step. All other requests are processed as usual.
      */
   
     // Performs DMA in standard mode
@@ -361,6 +438,21 @@ public:
     void performTurboDMA(Drive *d);
     void performTurboRead(Drive *drive);
     void performTurboWrite(Drive *drive);
+
+    /* Performs a standard track read on a high level. The function returns
+     * false if the request doesn't match the trackdisk.device pattern.
+     */
+    bool performHLERead(Drive *drive);
+
+
+    //
+    // Controlling warp mode
+    //
+
+private:
+
+    // Enters or leaves warp mode depending on the disk activity
+    void updateAutoWarp();
 };
 
 #endif
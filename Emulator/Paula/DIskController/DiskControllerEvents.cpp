@@ -12,8 +12,8 @@
 void
 DiskController::serviceDiskEvent()
 {        
-    // Receive next byte from the selected drive
-    executeFifo();
+    // Receive all bytes from the selected drive that are due
+    catchUp();
     
     // Schedule next event
     scheduleNextDiskEvent();
@@ -22,7 +22,9 @@ DiskController::serviceDiskEvent()
 void
 DiskController::scheduleFirstDiskEvent()
 {
-    dskEventDelay = 0.0;
+    rotationAnchor = agnus.clock;
+    rotationTicks = 0;
+    plannedTick = 0;
     
     if (turboMode()) {
         agnus.cancel<DSK_SLOT>();
@@ -34,20 +36,164 @@ DiskController::scheduleFirstDiskEvent()
 void
 DiskController::scheduleNextDiskEvent()
 {
-    /* Advance the delay counter to achieve a disk rotation speed of 300rpm.
-     * Rotation speed can be measured with AmigaTestKit.adf which calculates
-     * the delay between consecutive index pulses. 300rpm corresponds to a
-     * index pulse delay of 200ms.
-     */
-    dskEventDelay += 55.98;
-    DMACycle rounded = DMACycle(round(dskEventDelay));
-    dskEventDelay -= rounded;
-    
     if (turboMode()) {
         agnus.cancel<DSK_SLOT>();
+        return;
+    }
+    
+    // If DMA is running, each byte is processed individually
+    plannedTick = isIdle() ? nextObservableTick() : rotationTicks;
+    
+    if (plannedTick == NEVER) {
+        agnus.cancel<DSK_SLOT>();
     } else {
-        agnus.scheduleRel<DSK_SLOT>(DMA_CYCLES(rounded), DSK_ROTATE);
+        agnus.scheduleAbs<DSK_SLOT>(tickCycle(plannedTick), DSK_ROTATE);
+    }
+}
+
+Cycle
+DiskController::tickCycle(i64 n)
+{
+    /* A new byte arrives every 55.98 DMA cycles to achieve a disk rotation
+     * speed of 300rpm. Rotation speed can be measured with AmigaTestKit.adf
+     * which calculates the delay between consecutive index pulses. 300rpm
+     * corresponds to a index pulse delay of 200ms.
+     */
+    return rotationAnchor + DMA_CYCLES((n * 2799 + 25) / 50);
+}
+
+i64
+DiskController::ticksUntil(Cycle cycle)
+{
+    if (cycle < rotationAnchor) return 0;
+    
+    // Inverse function of tickCycle()
+    i64 elapsed = AS_DMA_CYCLES(cycle - rotationAnchor);
+    return (50 * elapsed + 24) / 2799 + 1;
+}
+
+void
+DiskController::catchUp()
+{
+    if (turboMode()) return;
+    
+    i64 target = ticksUntil(agnus.clock);
+    
+    while (rotationTicks < target) {
+        
+        // Skip all bytes without an observable effect
+        if (isIdle() && plannedTick > rotationTicks) {
+            
+            skipTicks(MIN(target, plannedTick) - rotationTicks);
+            continue;
+        }
+        
+        // Process the next byte individually
+        executeFifo();
+        rotationTicks++;
+        
+        if (isIdle() && plannedTick < rotationTicks) {
+            plannedTick = nextObservableTick();
+        }
+    }
+}
+
+i64
+DiskController::nextObservableTick()
+{
+    Drive *drive = getSelectedDrive();
+    i64 k = rotationTicks;
+    i64 result = NEVER;
+    u8 prev = fifo & 0xFF;
+    
+    // The watchdog fires when the counter exceeds 20000 (auto DSKSYNC)
+    if (config.autoDskSync) result = k + MAX(0, 20001 - syncCounter);
+    
+    // Without a drive, the controller reads zeroes
+    if (!drive) {
+        if (HI_LO(prev, 0) == dsksync || dsksync == 0) result = k;
+        return result;
+    }
+    
+    // The first byte after a head movement delivers valid data again
+    if (drive->isStepping(tickCycle(k))) {
+        
+        Cycle end = drive->stepCycle + drive->config.stepDelay;
+        result = MIN(result, ticksUntil(end - 1));
     }
+    
+    // If the disk doesn't spin, the drive delivers the same byte over and over
+    if (!drive->motor) {
+        
+        u8 byte = drive->peekByte(drive->head.offset, tickCycle(k));
+        if (HI_LO(prev, byte) == dsksync || HI_LO(byte, byte) == dsksync) {
+            result = k;
+        }
+        return result;
+    }
+    
+    // Without a disk, the drive delivers $FF and no index pulses
+    if (!drive->disk) {
+        if (HI_LO(prev, 0xFF) == dsksync || dsksync == 0xFFFF) result = k;
+        return result;
+    }
+    
+    // An index pulse is triggered when the head wraps over
+    long last = drive->disk->getTrackSize() - 1 - drive->head.offset;
+    result = MIN(result, k + last);
+    
+    // While the head is moving, the drive delivers $FF
+    if (drive->isStepping(tickCycle(k))) {
+        if (HI_LO(prev, 0xFF) == dsksync || dsksync == 0xFFFF) result = k;
+        return result;
+    }
+    
+    // Check if the first byte completes a SYNC mark
+    Track t = 2 * drive->head.cylinder + drive->head.side;
+    u8 byte = drive->disk->readByte(t, drive->head.offset);
+    if (HI_LO(prev, byte) == dsksync) return k;
+    
+    // Look up the next SYNC mark in the index
+    long pos = drive->disk->nextSyncMark(t, dsksync, drive->head.offset + 1);
+    if (pos >= 0) result = MIN(result, k + (pos - drive->head.offset));
+    
+    return result;
+}
+
+void
+DiskController::skipTicks(i64 count)
+{
+    assert(count > 0);
+    assert(isIdle());
+    
+    Drive *drive = getSelectedDrive();
+    
+    // Only the last eight bytes remain visible in the FIFO
+    i64 replay = MIN(count, 8);
+    i64 fill = fifoCount + (count - replay);
+    fifoCount = (u8)(fill <= 6 ? fill : 6 - ((fill - 6) & 1));
+    
+    for (i64 i = count - replay; i < count; i++) {
+        
+        u8 byte = 0;
+        
+        if (drive) {
+            
+            long offset = drive->head.offset + (drive->motor ? i : 0);
+            if (drive->disk) offset %= drive->disk->getTrackSize();
+            byte = drive->peekByte((u16)offset, tickCycle(rotationTicks + i));
+        }
+        writeFifo(byte);
+        incoming = byte | 0x8000;
+    }
+    
+    // Advance the watchdog counter
+    if (config.autoDskSync) syncCounter += (i16)count;
+    
+    // Rotate the disk
+    if (drive && drive->motor) drive->rotate(count);
+    
+    rotationTicks += count;
 }
 
 void
@@ -24,7 +24,9 @@ DiskController::pokeDSKLEN(u16 value)
 {
     trace(DSKREG_DEBUG, "pokeDSKLEN(%X)\n", value);
 
+    catchUp();
     setDSKLEN(dsklen, value);
+    scheduleNextDiskEvent();
 }
 
 void
@@ -87,6 +89,9 @@ DiskController::setDSKLEN(u16 oldValue, u16 newValue)
         }
     }
         
+    // Short-cut standard track reads if HLE is enabled
+    if (state == DRIVE_DMA_WAIT && performHLERead(drive)) return;
+
     // If turbo drives are emulated, perform DMA immediately
     if (turboMode()) performTurboDMA(drive);
 }
@@ -103,6 +108,7 @@ DiskController::pokeDSKDAT(u16 value)
 u16
 DiskController::peekDSKBYTR()
 {
+    catchUp();
     u16 result = computeDSKBYTR();
     
     debug(DSKREG_DEBUG, "peekDSKBYTR() = %x\n", result);
@@ -154,7 +160,9 @@ DiskController::pokeDSKSYNC(u16 value)
         }
     }
     
+    catchUp();
     dsksync = value;
+    scheduleNextDiskEvent();
 }
 
 u8
@@ -175,6 +183,9 @@ DiskController::PRBdidChange(u8 oldValue, u8 newValue)
 {
     // debug("PRBdidChange: %X -> %X\n", oldValue, newValue);
 
+    // Process all bytes that have been received with the old settings
+    catchUp();
+    
     // Store a copy of the new value for reference
     prb = newValue;
     
@@ -201,4 +212,6 @@ DiskController::PRBdidChange(u8 oldValue, u8 newValue)
         }
         if (selected != -1) messageQueue.put(MSG_DRIVE_SELECT, selected);
     }
+    
+    scheduleNextDiskEvent();
 }
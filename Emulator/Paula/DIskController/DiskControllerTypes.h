@@ -64,6 +64,16 @@ typedef struct
 
     bool lockDskSync;
     bool autoDskSync;
+
+    /* High-level emulation of trackdisk.device reads. If enabled, standard
+     * track reads are performed in a single step and the DSKBLK interrupt is
+     * triggered hleDelay microseconds later.
+     */
+    bool hle;
+    long hleDelay;
+    
+    // Switches to warp mode automatically while a disk is accessed
+    bool autoWarp;
 }
 DiskControllerConfig;
 
@@ -89,4 +99,23 @@ typedef struct
 }
 DiskControllerInfo;
 
+typedef struct
+{
+    // Number of times warp mode has been entered automatically
+    long autoWarps;
+    
+    // Number of frames emulated in auto-warp mode
+    long warpFrames;
+    
+    // Number of frames that have not been drawn in auto-warp mode
+    long skippedFrames;
+    
+    // Emulated time spent in auto-warp mode (in master cycles)
+    i64 warpCycles;
+    
+    // Host time spent in auto-warp mode (in nanoseconds)
+    i64 warpNanos;
+}
+DiskControllerStats;
+
 #endif
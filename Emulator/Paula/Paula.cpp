@@ -20,6 +20,7 @@ Paula::Paula(Amiga& ref) : AmigaComponent(ref)
         &channel2,
         &channel3,
         &muxer,
+        &renderer,
         &diskController,
         &uart
     };
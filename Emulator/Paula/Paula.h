@@ -13,6 +13,7 @@
 #include "StateMachine.h"
 #include "AudioFilter.h"
 #include "Muxer.h"
+#include "OfflineRenderer.h"
 #include "AudioStream.h"
 #include "Buffers.h"
 #include "DiskController.h"
@@ -43,6 +44,9 @@ public:
     // Audio muxer
     Muxer muxer = Muxer(amiga);
 
+    // Audio renderer for synthesizing audio streams offline
+    OfflineRenderer renderer = OfflineRenderer(amiga);
+
     // Disk controller
     DiskController diskController = DiskController(amiga);
 
@@ -32,6 +32,8 @@
 
 static USHORT Process_Track(FILE *, FILE *, UCHAR *, UCHAR *, USHORT, USHORT, USHORT);
 static USHORT Unpack_Track(UCHAR *, UCHAR *, USHORT, USHORT, UCHAR, UCHAR);
+static USHORT Process_TrackMem(const UCHAR **, const UCHAR *, UCHAR **, UCHAR *, UCHAR *, UCHAR *);
+static USHORT Unpack_TrackTo(UCHAR *, UCHAR *, UCHAR *, USHORT, USHORT, UCHAR, UCHAR);
 static void printbandiz(UCHAR *, USHORT);
 static void dms_decrypt(UCHAR *, USHORT);
 
@@ -158,6 +160,78 @@ USHORT extractDMS(FILE *fi, FILE *fo) {
     return ret;
 }
 
+// In-memory entry point for vAmiga (Dirk Hoffmann)
+USHORT extractDMSFromBuffer(const UCHAR *in, ULONG inlen, UCHAR *out, ULONG *outlen) {
+    
+    const UCHAR *pos = in, *end = in + inlen;
+    UCHAR *dst = out, *dstend = out ? out + *outlen : NULL;
+    USHORT geninfo, hcrc, ret;
+    UCHAR *b1, *b2;
+    
+    /*  Check the archive header  */
+    if (inlen < HEADLEN) return ERR_SREAD;
+    if ( (in[0] != 'D') || (in[1] != 'M') || (in[2] != 'S') || (in[3] != '!') ) return ERR_NOTDMS;
+    
+    hcrc = (USHORT)((in[HEADLEN-2]<<8) | in[HEADLEN-1]);
+    if (hcrc != CreateCRC((UCHAR *)in+4,(ULONG)(HEADLEN-6))) return ERR_HCRC;
+    
+    geninfo = (USHORT) ((in[10]<<8) | in[11]);
+    if (((in[50]<<8) | in[51]) == 7) return ERR_FMS;
+    if (geninfo & 2) return ERR_NOPASSWD;
+    
+    pos += HEADLEN;
+    
+    /*  Dry run: Only sum up the sizes of the disk tracks  */
+    if (!out) {
+        
+        *outlen = 0;
+        
+        while (end - pos >= THLEN) {
+            
+            USHORT number, pklen1, unpklen;
+            
+            if ((pos[0] != 'T')||(pos[1] != 'R')) break;
+            if (CreateCRC((UCHAR *)pos,(ULONG)(THLEN-2)) != (USHORT)((pos[THLEN-2] << 8) | pos[THLEN-1]))
+                return ERR_THCRC;
+            
+            number = (USHORT)((pos[2] << 8) | pos[3]);
+            pklen1 = (USHORT)((pos[6] << 8) | pos[7]);
+            unpklen = (USHORT)((pos[10] << 8) | pos[11]);
+            
+            if ((number<80) && (unpklen>2048)) *outlen += unpklen;
+            pos += THLEN + pklen1;
+        }
+        return NO_PROBLEM;
+    }
+    
+    b1 = (UCHAR *)calloc((size_t)TRACK_BUFFER_LEN,1);
+    b2 = (UCHAR *)calloc((size_t)TRACK_BUFFER_LEN,1);
+    text = (UCHAR *)calloc((size_t)TEMP_BUFFER_LEN,1);
+    
+    if (!b1 || !b2 || !text) {
+        free(b1);
+        free(b2);
+        free(text);
+        return ERR_NOMEMORY;
+    }
+    
+    PWDCRC = 0;
+    Init_Decrunchers();
+    
+    while ( (ret=Process_TrackMem(&pos,end,&dst,dstend,b1,b2)) == NO_PROBLEM ) ;
+    
+    if (ret == FILE_END) ret = NO_PROBLEM;
+    if (ret == ERR_NOTTRACK) ret = NO_PROBLEM;
+    
+    *outlen = (ULONG)(dst - out);
+    
+    free(b1);
+    free(b2);
+    free(text);
+    
+    return ret;
+}
+
 USHORT Process_File(char *iname, char *oname, USHORT cmd, USHORT opt, USHORT PCRC, USHORT pwd){
     FILE *fi, *fo=NULL;
     USHORT from, to, geninfo, c_version, cmode, hcrc, disktype, pv, ret;
@@ -543,6 +617,115 @@ static USHORT Process_Track(FILE *fi, FILE *fo, UCHAR *b1, UCHAR *b2,
 
 
 
+/*  Processes a single track stored in memory. The unpacked data is directly   */
+/*  written to the output buffer if the track belongs to the disk image.      */
+static USHORT Process_TrackMem(const UCHAR **pos, const UCHAR *end,
+                UCHAR **dst, UCHAR *dstend, UCHAR *b1, UCHAR *b2)
+{
+    USHORT hcrc, dcrc, usum, number, pklen1, pklen2, unpklen, r;
+    UCHAR cmode, flags;
+    const UCHAR *p = *pos;
+
+    if (p == end) return FILE_END;
+    if (end - p < THLEN) return ERR_SREAD;
+
+    /*  "TR" identifies a Track Header  */
+    if ((p[0] != 'T')||(p[1] != 'R')) return ERR_NOTTRACK;
+
+    /*  Track Header CRC  */
+    hcrc = (USHORT)((p[THLEN-2] << 8) | p[THLEN-1]);
+
+    if (CreateCRC((UCHAR *)p,(ULONG)(THLEN-2)) != hcrc)
+        return ERR_THCRC;
+
+    number = (USHORT)((p[2] << 8) | p[3]);
+    pklen1 = (USHORT)((p[6] << 8) | p[7]);
+    pklen2 = (USHORT)((p[8] << 8) | p[9]);
+    unpklen = (USHORT)((p[10] << 8) | p[11]);
+    flags = p[12];
+    cmode = p[13];
+    usum = (USHORT)((p[14] << 8) | p[15]);
+    dcrc = (USHORT)((p[16] << 8) | p[17]);
+
+    if ((pklen1 > TRACK_BUFFER_LEN) || (pklen2 >TRACK_BUFFER_LEN) || (unpklen > TRACK_BUFFER_LEN)) return ERR_BIGTRACK;
+
+    p += THLEN;
+    if (end - p < pklen1) return ERR_SREAD;
+    *pos = p + pklen1;
+
+    /*  Only tracks belonging to the disk image are unpacked  */
+    if ((number>=80) || (unpklen<=2048)) return NO_PROBLEM;
+    if (dstend - *dst < unpklen) return ERR_CANTWRITE;
+
+    if (CreateCRC((UCHAR *)p,(ULONG)pklen1) != dcrc) {
+        if (!OverrideErrors) return ERR_TDCRC;
+    }
+
+    /*  The decrunchers may read beyond the packed data. Hence, we unpack   */
+    /*  from a copy which is padded with zeroes                              */
+    memcpy(b1, p, (size_t)pklen1);
+    memset(b1 + pklen1, 0, (size_t)(TRACK_BUFFER_LEN - pklen1));
+
+    r = Unpack_TrackTo(b1, b2, *dst, pklen2, unpklen, cmode, flags);
+    if (r != NO_PROBLEM) {
+        if (!OverrideErrors) return r;
+    }
+    if (usum != Calc_CheckSum(*dst,(ULONG)unpklen)) {
+        if (!OverrideErrors) return ERR_CSUM;
+    }
+
+    *dst += unpklen;
+    return NO_PROBLEM;
+}
+
+
+
+/*  Same as Unpack_Track, but the final decompression stage writes into dst  */
+static USHORT Unpack_TrackTo(UCHAR *b1, UCHAR *b2, UCHAR *dst, USHORT pklen2,
+               USHORT unpklen, UCHAR cmode, UCHAR flags)
+{
+    memset(b2, 0, unpklen);
+
+    switch (cmode){
+        case 0:
+            memcpy(dst,b1,(size_t)unpklen);
+            break;
+        case 1:
+            if (Unpack_RLE(b1,dst,unpklen)) return ERR_BADDECR;
+            break;
+        case 2:
+            if (Unpack_QUICK(b1,b2,pklen2)) return ERR_BADDECR;
+            if (Unpack_RLE(b2,dst,unpklen)) return ERR_BADDECR;
+            break;
+        case 3:
+            if (Unpack_MEDIUM(b1,b2,pklen2)) return ERR_BADDECR;
+            if (Unpack_RLE(b2,dst,unpklen)) return ERR_BADDECR;
+            break;
+        case 4:
+            if (Unpack_DEEP(b1,b2,pklen2)) return ERR_BADDECR;
+            if (Unpack_RLE(b2,dst,unpklen)) return ERR_BADDECR;
+            break;
+        case 5:
+        case 6:
+            if (Unpack_HEAVY(b1,b2,(cmode==5) ? (flags & 7) : (flags | 8),pklen2)) return ERR_BADDECR;
+            if (flags & 4) {
+                if (Unpack_RLE(b2,dst,unpklen)) return ERR_BADDECR;
+            } else {
+                /*  The decruncher may overshoot. Hence, it never writes into dst  */
+                memcpy(dst,b2,(size_t)unpklen);
+            }
+            break;
+        default:
+            return ERR_UNKNMODE;
+    }
+
+    if (!(flags & 1)) Init_Decrunchers();
+
+    return NO_PROBLEM;
+}
+
+
+
 static USHORT Unpack_Track(UCHAR *b1, UCHAR *b2, USHORT pklen2, USHORT unpklen,
                UCHAR cmode, UCHAR flags)
 {
@@ -43,3 +43,4 @@ extern int OverrideErrors;
 
 
 USHORT Process_File(char *, char *, USHORT, USHORT, USHORT, USHORT);
+USHORT extractDMSFromBuffer(const UCHAR *, ULONG, UCHAR *, ULONG *);
@@ -140,16 +140,17 @@ class MyController: NSWindowController, MessageReceiver {
             
     func updateWarp() {
         
-        var warp: Bool
+        let auto = pref.warpMode == .auto
         
-        switch pref.warpMode {
-        case .auto: warp = amiga.diskController.isSpinning
-        case .off: warp = false
-        case .on: warp = true
+        // In auto mode, the disk controller switches warp mode on its own
+        if auto != (amiga.getConfig(.OPT_AUTO_WARP) != 0) {
+            
+            amiga.configure(.OPT_AUTO_WARP, enable: auto)
+            if auto && amiga.warp { amiga.warpOff() }
         }
         
-        if warp != amiga.warp {
-            warp ? amiga.warpOn() : amiga.warpOff()
+        if !auto && (pref.warpMode == .on) != amiga.warp {
+            pref.warpMode == .on ? amiga.warpOn() : amiga.warpOff()
         }
     }
 
@@ -552,7 +553,6 @@ extension MyController {
         case .MSG_DRIVE_MOTOR_ON,
              .MSG_DRIVE_MOTOR_OFF:
             refreshStatusBar()
-            updateWarp()
 
         case .MSG_DRIVE_HEAD:
             if pref.driveSounds && pref.driveHeadSound {
@@ -615,6 +615,12 @@ extension MyController {
 
             window?.backgroundColor = .windowBackgroundColor
             refreshStatusBar()
+
+        case .MSG_RECORDING_ABORTED:
+
+            window?.backgroundColor = .windowBackgroundColor
+            refreshStatusBar()
+            showRecordingAbortedAlert()
             
         default:
             track("Unknown message: \(msg)")
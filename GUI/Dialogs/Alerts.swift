@@ -209,6 +209,17 @@ extension MyController {
         alert.runModal()
     }
 
+    func showRecordingAbortedAlert() {
+        
+        let alert = NSAlert()
+        alert.alertStyle = .warning
+        alert.icon = NSImage.init(named: "FFmpegIcon")
+        alert.messageText = "The screen recording has been aborted."
+        alert.informativeText = "The recorded data could not be written."
+        alert.addButton(withTitle: "OK")
+        alert.runModal()
+    }
+
     func showScreenRecorderAlert(url: URL) {
 
         let alert = NSAlert()
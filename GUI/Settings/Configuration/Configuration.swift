@@ -204,6 +204,10 @@ class Configuration {
         get { return amiga.getConfig(.OPT_CLX_PLF_PLF) != 0 }
         set { amiga.configure(.OPT_CLX_PLF_PLF, enable: newValue) }
     }
+    var renderThread: Bool {
+        get { return amiga.getConfig(.OPT_RENDER_THREAD) != 0 }
+        set { amiga.configure(.OPT_RENDER_THREAD, enable: newValue) }
+    }
     var driveSpeed: Int {
         get { return amiga.getConfig(.OPT_DRIVE_SPEED) }
         set { amiga.configure(.OPT_DRIVE_SPEED, value: newValue) }
@@ -266,6 +270,10 @@ class Configuration {
         get { return amiga.getConfig(.OPT_AUDPAN3) }
         set { amiga.configure(.OPT_AUDPAN3, value: newValue) }
     }
+    var latency: Int {
+        get { return amiga.getConfig(.OPT_AUDLATENCY) }
+        set { amiga.configure(.OPT_AUDLATENCY, value: newValue) }
+    }
     var volL: Int {
         get { return amiga.getConfig(.OPT_AUDVOLL) }
         set { amiga.configure(.OPT_AUDVOLL, value: newValue) }
@@ -174,6 +174,9 @@ struct SerialPortWrapper;
 - (void) warpOn;
 - (void) warpOff;
 
+- (NSInteger) renderAudio:(NSInteger)frames buffer1:(float *)left buffer2:(float *)right size:(NSInteger)n;
+- (BOOL) renderAudio:(NSInteger)frames url:(NSURL *)url;
+
 @end
 
 
@@ -443,6 +446,15 @@ struct SerialPortWrapper;
 @property (readonly) BOOL hasFFmpeg;
 @property (readonly) BOOL recording;
 @property (readonly) NSInteger recordCounter;
+@property RecordingPolicy policy;
+@property VideoFormat format;
+@property RecordingSink sink;
+@property BOOL mappedOutput;
+
+- (BOOL) setPath:(NSString *)path;
+
+- (RecorderStats) getStats;
+- (void) clearStats;
 
 - (BOOL) startRecording:(NSRect)rect
                 bitRate:(NSInteger)rate
@@ -591,6 +603,8 @@ struct SerialPortWrapper;
 - (void) dump;
 - (DiskControllerConfig) getConfig;
 - (DiskControllerInfo) getInfo;
+- (DiskControllerStats) getStats;
+- (void) clearStats;
 @property (readonly) NSInteger selectedDrive;
 @property (readonly) DriveState state;
 @property (readonly, getter=isSpinning) BOOL spinning;
@@ -632,6 +646,10 @@ struct SerialPortWrapper;
 
 - (ADFFileProxy *)convertDisk;
 
+- (BOOL) setBackingFile:(NSString *)path;
+- (void) clearBackingFile;
+- (void) flushDisk;
+
 @end
 
 
@@ -699,6 +717,12 @@ struct SerialPortWrapper;
 @property (readonly) NSInteger numTracks;
 @property (readonly) NSInteger numSectorsPerTrack;
 
++ (DiskCacheStats)cacheStats;
++ (void)setCacheCapacity:(NSInteger)bytes;
++ (void)setCacheDirectory:(NSString *)path;
++ (void)setCacheDirectoryCapacity:(NSInteger)bytes;
++ (void)clearCache;
+
 @end
 
 
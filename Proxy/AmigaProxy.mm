@@ -762,6 +762,50 @@ struct SerialPortWrapper { SerialPort *port; };
 {
     return wrapper->screenRecorder->getRecordCounter();
 }
+- (RecordingPolicy) policy
+{
+    return wrapper->screenRecorder->getPolicy();
+}
+- (void) setPolicy:(RecordingPolicy)value
+{
+    wrapper->screenRecorder->setPolicy(value);
+}
+- (VideoFormat) format
+{
+    return wrapper->screenRecorder->getFormat();
+}
+- (void) setFormat:(VideoFormat)value
+{
+    wrapper->screenRecorder->setFormat(value);
+}
+- (RecordingSink) sink
+{
+    return wrapper->screenRecorder->getSink();
+}
+- (void) setSink:(RecordingSink)value
+{
+    wrapper->screenRecorder->setSink(value);
+}
+- (BOOL) mappedOutput
+{
+    return wrapper->screenRecorder->getMappedOutput();
+}
+- (void) setMappedOutput:(BOOL)value
+{
+    wrapper->screenRecorder->setMappedOutput(value);
+}
+- (BOOL) setPath:(NSString *)path
+{
+    return wrapper->screenRecorder->setPath([path fileSystemRepresentation]);
+}
+- (RecorderStats) getStats
+{
+    return wrapper->screenRecorder->getStats();
+}
+- (void) clearStats
+{
+    wrapper->screenRecorder->clearStats();
+}
 - (BOOL) startRecording:(NSRect)rect
                 bitRate:(NSInteger)rate
                 aspectX:(NSInteger)aspectX
@@ -1086,6 +1130,14 @@ struct SerialPortWrapper { SerialPort *port; };
 {
     return wrapper->controller->getInfo();
 }
+- (DiskControllerStats) getStats
+{
+    return wrapper->controller->getStats();
+}
+- (void) clearStats
+{
+    wrapper->controller->clearStats();
+}
 - (NSInteger) selectedDrive
 {
     return wrapper->controller->getSelected();
@@ -1207,6 +1259,20 @@ struct SerialPortWrapper { SerialPort *port; };
 {
     return NULL;
 }
+- (BOOL) setBackingFile:(NSString *)path
+{
+    return wrapper->drive->setBackingFile([path fileSystemRepresentation]);
+}
+
+- (void) clearBackingFile
+{
+    wrapper->drive->clearBackingFile();
+}
+
+- (void) flushDisk
+{
+    wrapper->drive->flushDisk();
+}
 
 
 @end
@@ -1403,6 +1469,26 @@ struct SerialPortWrapper { SerialPort *port; };
 {
     return ((DiskFile *)wrapper->file)->numSectorsPerTrack();
 }
++ (DiskCacheStats)cacheStats
+{
+    return DiskCache::shared().getStats();
+}
++ (void)setCacheCapacity:(NSInteger)bytes
+{
+    DiskCache::shared().setCapacity(bytes);
+}
++ (void)setCacheDirectory:(NSString *)path
+{
+    DiskCache::shared().setDirectory([path fileSystemRepresentation]);
+}
++ (void)setCacheDirectoryCapacity:(NSInteger)bytes
+{
+    DiskCache::shared().setDirectoryCapacity(bytes);
+}
++ (void)clearCache
+{
+    DiskCache::shared().clear();
+}
 
 @end
 
@@ -1846,5 +1932,13 @@ struct SerialPortWrapper { SerialPort *port; };
 {
     wrapper->amiga->setWarp(false);
 }
+- (NSInteger) renderAudio:(NSInteger)frames buffer1:(float *)left buffer2:(float *)right size:(NSInteger)n
+{
+    return wrapper->amiga->renderAudio(frames, left, right, n);
+}
+- (BOOL) renderAudio:(NSInteger)frames url:(NSURL *)url
+{
+    return wrapper->amiga->renderAudio(frames, [url fileSystemRepresentation]);
+}
 
 @end